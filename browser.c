@@ -584,7 +584,7 @@ static int examine_directory(MUTTMENU *menu, struct browser_state *state,
 
     if (prefix && *prefix && mutt_strncmp(prefix, de->d_name, mutt_strlen(prefix)) != 0)
       continue;
-    if (!((regexec(Mask.rx, de->d_name, 0, NULL, 0) == 0) ^ Mask.not))
+    if (!((mutt_regexec(&Mask, de->d_name, 0, NULL, 0) == 0) ^ Mask.not))
       continue;
 
     mutt_buffer_concat_path(full_path, d, de->d_name);
@@ -1373,6 +1373,7 @@ void _mutt_buffer_select_file(BUFFER *f, int flags, char ***files, int *numfiles
             FREE(&Mask.rx);
             Mask.rx = rx;
             Mask.not = not;
+            mutt_set_regexp_literal(&Mask, s, REG_NOSUB);
 
             destroy_state(&state);
 #ifdef USE_IMAP
@@ -240,6 +240,9 @@ static BUFFY *buffy_new(const char *path)
   buffy->realpath = safe_strdup(r ? rp : path);
   buffy->next = NULL;
   buffy->magic = 0;
+#ifdef USE_INOTIFY
+  buffy->monitor_descr = -1;
+#endif
 
   return buffy;
 }
@@ -563,6 +566,47 @@ cleanup:
   return rc;
 }
 
+/* Message counts of a maildir can only change when a message is added,
+ * removed or renamed, all of which update the mtime of new/ or cur/.
+ * Returns 1 if either was modified since the counts were last calculated,
+ * and records the new modification time.
+ */
+static int buffy_maildir_stats_changed(BUFFY *mailbox)
+{
+  static const char *subdirs[] = { "new", "cur" };
+  BUFFER *path = NULL;
+  struct stat sb;
+  struct timespec mtime, latest = { 0, 0 };
+  int i, rc = 0;
+
+  path = mutt_buffer_pool_get();
+
+  for (i = 0; i < sizeof(subdirs) / sizeof(subdirs[0]); i++)
+  {
+    mutt_buffer_printf(path, "%s/%s", mutt_b2s(mailbox->pathbuf), subdirs[i]);
+    if (stat(mutt_b2s(path), &sb) != 0)
+    {
+      /* let the scan deal with it, and make sure the next one happens too */
+      latest.tv_sec = 0;
+      latest.tv_nsec = 0;
+      rc = 1;
+      break;
+    }
+    mutt_get_stat_timespec(&mtime, &sb, MUTT_STAT_MTIME);
+    if (mutt_timespec_compare(&mtime, &latest) > 0)
+      latest = mtime;
+  }
+
+  if (rc || mutt_timespec_compare(&latest, &mailbox->stats_last_checked) > 0)
+  {
+    mailbox->stats_last_checked = latest;
+    rc = 1;
+  }
+
+  mutt_buffer_pool_release(&path);
+  return rc;
+}
+
 /* Checks new mail for a maildir mailbox.
  * check_stats: if true, also count total, new, and flagged messages.
  * Returns 1 if the mailbox has new mail.
@@ -571,6 +615,9 @@ static int buffy_maildir_check(BUFFY *mailbox, int check_stats)
 {
   int rc, check_new = 1;
 
+  if (check_stats && !buffy_maildir_stats_changed(mailbox))
+    check_stats = 0;
+
   if (check_stats)
   {
     mailbox->msg_count   = 0;
@@ -643,6 +690,111 @@ static int buffy_mbox_check(BUFFY *mailbox, struct stat *sb, int check_stats)
   return rc;
 }
 
+/* Checks a single mailbox for new mail, and total/new/flagged messages
+ * when check_stats is set.
+ * Returns 1 if the mailbox has new mail, -1 if it doesn't exist (yet).
+ */
+static int buffy_check(BUFFY *tmp, struct stat *contex_sb, int check_stats)
+{
+  struct stat sb;
+  int rc = 0;
+#ifdef USE_SIDEBAR
+  short orig_new;
+  int orig_count, orig_unread, orig_flagged;
+
+  orig_new = tmp->new;
+  orig_count = tmp->msg_count;
+  orig_unread = tmp->msg_unread;
+  orig_flagged = tmp->msg_flagged;
+#endif
+
+  sb.st_size = 0;
+  sb.st_dev = 0;
+  sb.st_ino = 0;
+
+  if (tmp->magic != MUTT_IMAP)
+  {
+    tmp->new = 0;
+#ifdef USE_POP
+    if (mx_is_pop(mutt_b2s(tmp->pathbuf)))
+      tmp->magic = MUTT_POP;
+    else
+#endif
+      if (stat(mutt_b2s(tmp->pathbuf), &sb) != 0 ||
+          (S_ISREG(sb.st_mode) && sb.st_size == 0) ||
+          (!tmp->magic &&
+           (tmp->magic = mx_get_magic(mutt_b2s(tmp->pathbuf))) <= 0))
+      {
+        /* if the mailbox still doesn't exist, set the newly created flag to
+         * be ready for when it does. */
+        tmp->newly_created = 1;
+        tmp->magic = 0;
+        tmp->size = 0;
+        return -1;
+      }
+#ifdef USE_INOTIFY
+      else if (tmp->monitor_descr == -1 && option(OPTMAILCHECKMONITOR))
+        /* the mailbox may not have existed when it was added */
+        mutt_monitor_add(tmp);
+#endif
+  }
+
+  /* check to see if the folder is the currently selected folder
+   * before polling */
+  if (!Context || !Context->path ||
+      ((tmp->magic == MUTT_IMAP || tmp->magic == MUTT_POP ) ?
+       mutt_strcmp(mutt_b2s(tmp->pathbuf), Context->path) :
+       (sb.st_dev != contex_sb->st_dev || sb.st_ino != contex_sb->st_ino)))
+  {
+    switch (tmp->magic)
+    {
+      case MUTT_MBOX:
+      case MUTT_MMDF:
+        rc = buffy_mbox_check(tmp, &sb, check_stats) > 0;
+        break;
+
+      case MUTT_MAILDIR:
+        rc = buffy_maildir_check(tmp, check_stats) > 0;
+        break;
+
+      case MUTT_MH:
+        rc = mh_buffy(tmp, check_stats) > 0;
+        break;
+    }
+  }
+  else if (option(OPTCHECKMBOXSIZE) && Context && Context->path)
+    tmp->size = (off_t) sb.st_size;   /* update the size of current folder */
+
+#ifdef USE_SIDEBAR
+  if ((orig_new != tmp->new) ||
+      (orig_count != tmp->msg_count) ||
+      (orig_unread != tmp->msg_unread) ||
+      (orig_flagged != tmp->msg_flagged))
+    mutt_set_current_menu_redraw(REDRAW_SIDEBAR);
+#endif
+
+  return rc;
+}
+
+#ifdef USE_INOTIFY
+/* With $mail_check_monitor, a mailbox with a working inotify watch
+ * is only looked at when the watch reported a change.  Between two
+ * regular polls, only such mailboxes are checked at all.  The watches
+ * don't report mail leaving a maildir's new/, so a mailbox with new
+ * mail is still polled to notice it being read elsewhere.
+ * Returns 1 if the mailbox can keep its previous state.
+ */
+static int buffy_monitor_skip(BUFFY *tmp, int force, int poll_due, int check_stats)
+{
+  if (force || tmp->monitor_changed)
+    return 0;
+  if (!poll_due)
+    return 1;
+  return option(OPTMAILCHECKMONITOR) && tmp->monitor_descr != -1 &&
+    !check_stats && !tmp->new;
+}
+#endif
+
 /* Check all Incoming for new mail and total/new/flagged messages
  * The force argument may be any combination of the following values:
  *   MUTT_BUFFY_CHECK_FORCE        ignore BuffyTimeout and check for new mail
@@ -651,16 +803,12 @@ static int buffy_mbox_check(BUFFY *mailbox, struct stat *sb, int check_stats)
 int mutt_buffy_check(int force)
 {
   BUFFY *tmp;
-  struct stat sb;
   struct stat contex_sb;
   time_t t;
   int check_stats = 0;
-#ifdef USE_SIDEBAR
-  short orig_new;
-  int orig_count, orig_unread, orig_flagged;
-#endif
+  int poll_due = 1;
+  int rc;
 
-  sb.st_size=0;
   contex_sb.st_dev=0;
   contex_sb.st_ino=0;
 
@@ -675,22 +823,38 @@ int mutt_buffy_check(int force)
     return 0;
   t = time(NULL);
   if (!force && (t - BuffyTime < BuffyTimeout))
-    return BuffyCount;
+  {
+#ifdef USE_INOTIFY
+    /* mailboxes whose watch fired are checked right away */
+    if (!option(OPTMAILCHECKMONITOR) || !MonitorBuffyChanged)
+#endif
+      return BuffyCount;
+    poll_due = 0;
+    check_stats = option(OPTMAILCHECKSTATS);
+  }
 
-  if ((force & MUTT_BUFFY_CHECK_FORCE_STATS) ||
-      (option(OPTMAILCHECKSTATS) &&
-       (t - BuffyStatsTime >= BuffyCheckStatsInterval)))
+  if (poll_due)
   {
-    check_stats = 1;
-    BuffyStatsTime = t;
+    if ((force & MUTT_BUFFY_CHECK_FORCE_STATS) ||
+        (option(OPTMAILCHECKSTATS) &&
+         (t - BuffyStatsTime >= BuffyCheckStatsInterval)))
+    {
+      check_stats = 1;
+      BuffyStatsTime = t;
+    }
+
+    BuffyTime = t;
   }
 
-  BuffyTime = t;
   BuffyCount = 0;
   BuffyNotify = 0;
+#ifdef USE_INOTIFY
+  MonitorBuffyChanged = 0;
+#endif
 
 #ifdef USE_IMAP
-  BuffyCount += imap_buffy_check(force, check_stats);
+  if (poll_due)
+    BuffyCount += imap_buffy_check(force, check_stats);
 #endif
 
   /* check device ID and serial number instead of comparing paths */
@@ -706,70 +870,22 @@ int mutt_buffy_check(int force)
     if (tmp->nopoll)
       continue;
 
-#ifdef USE_SIDEBAR
-    orig_new = tmp->new;
-    orig_count = tmp->msg_count;
-    orig_unread = tmp->msg_unread;
-    orig_flagged = tmp->msg_flagged;
-#endif
-
-    if (tmp->magic != MUTT_IMAP)
+#ifdef USE_INOTIFY
+    if (buffy_monitor_skip(tmp, force, poll_due, check_stats))
     {
-      tmp->new = 0;
-#ifdef USE_POP
-      if (mx_is_pop(mutt_b2s(tmp->pathbuf)))
-        tmp->magic = MUTT_POP;
-      else
-#endif
-        if (stat(mutt_b2s(tmp->pathbuf), &sb) != 0 ||
-            (S_ISREG(sb.st_mode) && sb.st_size == 0) ||
-            (!tmp->magic &&
-             (tmp->magic = mx_get_magic(mutt_b2s(tmp->pathbuf))) <= 0))
-        {
-          /* if the mailbox still doesn't exist, set the newly created flag to
-           * be ready for when it does. */
-          tmp->newly_created = 1;
-          tmp->magic = 0;
-          tmp->size = 0;
-          continue;
-        }
+      if (tmp->new)
+        BuffyCount++;
     }
-
-    /* check to see if the folder is the currently selected folder
-     * before polling */
-    if (!Context || !Context->path ||
-        ((tmp->magic == MUTT_IMAP || tmp->magic == MUTT_POP ) ?
-         mutt_strcmp(mutt_b2s(tmp->pathbuf), Context->path) :
-         (sb.st_dev != contex_sb.st_dev || sb.st_ino != contex_sb.st_ino)))
+    else
     {
-      switch (tmp->magic)
-      {
-        case MUTT_MBOX:
-        case MUTT_MMDF:
-          if (buffy_mbox_check(tmp, &sb, check_stats) > 0)
-            BuffyCount++;
-          break;
-
-        case MUTT_MAILDIR:
-          if (buffy_maildir_check(tmp, check_stats) > 0)
-            BuffyCount++;
-          break;
-
-        case MUTT_MH:
-          if (mh_buffy(tmp, check_stats) > 0)
-            BuffyCount++;
-          break;
-      }
+      tmp->monitor_changed = 0;
+#endif
+      if ((rc = buffy_check(tmp, &contex_sb, check_stats)) < 0)
+        continue;
+      if (rc > 0)
+        BuffyCount++;
+#ifdef USE_INOTIFY
     }
-    else if (option(OPTCHECKMBOXSIZE) && Context && Context->path)
-      tmp->size = (off_t) sb.st_size;   /* update the size of current folder */
-
-#ifdef USE_SIDEBAR
-    if ((orig_new != tmp->new) ||
-        (orig_count != tmp->msg_count) ||
-        (orig_unread != tmp->msg_unread) ||
-        (orig_flagged != tmp->msg_flagged))
-      mutt_set_current_menu_redraw(REDRAW_SIDEBAR);
 #endif
 
     if (!tmp->new)
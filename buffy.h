@@ -41,7 +41,12 @@ typedef struct buffy_t
   short magic;                  /* mailbox type */
   short newly_created;          /* mbox or mmdf just popped into existence */
   struct timespec last_visited;         /* time of last exit from this mailbox */
-  struct timespec stats_last_checked;   /* mtime of mailbox the last time stats where checked. */
+  struct timespec stats_last_checked;   /* mtime of mailbox (maildir: latest of new/ and cur/)
+                                           the last time stats where checked. */
+#ifdef USE_INOTIFY
+  int monitor_descr;            /* inotify watch descriptor, or -1 if polled */
+  short monitor_changed;        /* watch reported a change since the last check */
+#endif
 } BUFFY;
 
 WHERE BUFFY *Incoming;
@@ -364,15 +364,16 @@ int iconv_close(iconv_t cd)
  * MUTT_ICONV_HOOK_FROM acts on charset-hooks, not at all on iconv-hooks.
  */
 
-iconv_t mutt_iconv_open(const char *tocode, const char *fromcode, int flags)
+/* Resolves tocode and fromcode to the names mutt_iconv_open() passes to
+ * iconv_open(), as described above. */
+static void iconv_resolve(char *tocode2, size_t tolen, const char *tocode,
+                          char *fromcode2, size_t fromlen, const char *fromcode,
+                          int flags)
 {
   char tocode1[SHORT_STRING];
   char fromcode1[SHORT_STRING];
-  char *tocode2, *fromcode2;
   char *tmp;
 
-  iconv_t cd;
-
   /* transform to MIME preferred charset names */
   mutt_canonical_charset(tocode1, sizeof(tocode1), tocode);
   mutt_canonical_charset(fromcode1, sizeof(fromcode1), fromcode);
@@ -384,16 +385,151 @@ iconv_t mutt_iconv_open(const char *tocode, const char *fromcode, int flags)
     mutt_canonical_charset(fromcode1, sizeof(fromcode1), tmp);
 
   /* always apply iconv-hooks to suit system's iconv tastes */
-  tocode2 = mutt_iconv_hook(tocode1);
-  tocode2 = (tocode2) ? tocode2 : tocode1;
-  fromcode2 = mutt_iconv_hook(fromcode1);
-  fromcode2 = (fromcode2) ? fromcode2 : fromcode1;
+  tmp = mutt_iconv_hook(tocode1);
+  strfcpy(tocode2, tmp ? tmp : tocode1, tolen);
+  tmp = mutt_iconv_hook(fromcode1);
+  strfcpy(fromcode2, tmp ? tmp : fromcode1, fromlen);
+}
+
+iconv_t mutt_iconv_open(const char *tocode, const char *fromcode, int flags)
+{
+  char tocode2[SHORT_STRING];
+  char fromcode2[SHORT_STRING];
+
+  iconv_resolve(tocode2, sizeof(tocode2), tocode,
+                fromcode2, sizeof(fromcode2), fromcode, flags);
 
   /* call system iconv with names it appreciates */
-  if ((cd = iconv_open(tocode2, fromcode2)) != (iconv_t) -1)
+  return iconv_open(tocode2, fromcode2);
+}
+
+
+/*
+ * A small cache of iconv descriptors, so that converting many headers
+ * or body parts in the same charsets doesn't pay for iconv_open() every
+ * time.  Entries are keyed by the names iconv_open() was called with, after
+ * canonicalisation and hooks, so differently spelled labels for the same
+ * charset share an entry and changing the hooks never returns a stale
+ * descriptor.  The least recently used idle entry is replaced when the
+ * cache is full.
+ * A descriptor handed out by mutt_iconv_open_cached() is busy until it
+ * is given back with mutt_iconv_release(), which resets its shift state.
+ */
+
+#define ICONV_CACHE_SIZE 8
+
+typedef struct
+{
+  char *tocode;
+  char *fromcode;
+  iconv_t cd;
+  int busy;
+  unsigned long used;   /* for LRU replacement */
+} ICONV_CACHE;
+
+static ICONV_CACHE IconvCache[ICONV_CACHE_SIZE];
+static unsigned long IconvCacheClock;
+static unsigned long IconvCacheHits;
+static unsigned long IconvCacheMisses;
+
+iconv_t mutt_iconv_open_cached(const char *tocode, const char *fromcode, int flags)
+{
+  ICONV_CACHE *c, *victim = NULL;
+  char tocode2[SHORT_STRING];
+  char fromcode2[SHORT_STRING];
+  iconv_t cd;
+  int i;
+
+  iconv_resolve(tocode2, sizeof(tocode2), tocode,
+                fromcode2, sizeof(fromcode2), fromcode, flags);
+
+  for (i = 0; i < ICONV_CACHE_SIZE; i++)
+  {
+    c = &IconvCache[i];
+    if (c->tocode && !c->busy &&
+        !mutt_strcmp(c->tocode, tocode2) && !mutt_strcmp(c->fromcode, fromcode2))
+    {
+      IconvCacheHits++;
+      c->busy = 1;
+      c->used = ++IconvCacheClock;
+      return c->cd;
+    }
+  }
+
+  IconvCacheMisses++;
+  if ((cd = iconv_open(tocode2, fromcode2)) == (iconv_t)(-1))
     return cd;
 
-  return (iconv_t) -1;
+  for (i = 0; i < ICONV_CACHE_SIZE; i++)
+  {
+    c = &IconvCache[i];
+    if (c->busy)
+      continue;
+    if (!c->tocode)
+    {
+      victim = c;
+      break;
+    }
+    if (!victim || c->used < victim->used)
+      victim = c;
+  }
+
+  /* all busy: the caller gets a private descriptor */
+  if (!victim)
+    return cd;
+
+  if (victim->tocode)
+  {
+    iconv_close(victim->cd);
+    FREE(&victim->tocode);
+    FREE(&victim->fromcode);
+  }
+  victim->tocode = safe_strdup(tocode2);
+  victim->fromcode = safe_strdup(fromcode2);
+  victim->cd = cd;
+  victim->busy = 1;
+  victim->used = ++IconvCacheClock;
+
+  return cd;
+}
+
+void mutt_iconv_release(iconv_t cd)
+{
+  int i;
+
+  if (cd == (iconv_t)(-1))
+    return;
+
+  for (i = 0; i < ICONV_CACHE_SIZE; i++)
+    if (IconvCache[i].tocode && IconvCache[i].busy && IconvCache[i].cd == cd)
+    {
+      iconv(cd, 0, 0, 0, 0);
+      IconvCache[i].busy = 0;
+      return;
+    }
+
+  iconv_close(cd);
+}
+
+/* Drop the cached descriptors at exit. */
+void mutt_iconv_cache_flush(void)
+{
+  int i;
+
+  muttdbg(2, "iconv cache: %lu hits, %lu misses",
+          IconvCacheHits, IconvCacheMisses);
+
+  for (i = 0; i < ICONV_CACHE_SIZE; i++)
+  {
+    if (!IconvCache[i].tocode)
+      continue;
+    /* a busy descriptor is closed by mutt_iconv_release() instead */
+    if (!IconvCache[i].busy)
+      iconv_close(IconvCache[i].cd);
+    FREE(&IconvCache[i].tocode);
+    FREE(&IconvCache[i].fromcode);
+    IconvCache[i].busy = 0;
+  }
 }
 
 
@@ -485,7 +621,7 @@ int mutt_convert_string(char **ps, const char *from, const char *to, int flags)
   if (!s || !*s)
     return 0;
 
-  if (to && from && (cd = mutt_iconv_open(to, from, flags)) != (iconv_t)-1)
+  if (to && from && (cd = mutt_iconv_open_cached(to, from, flags)) != (iconv_t)-1)
   {
     ICONV_CONST char *ib;
     char *buf, *ob;
@@ -504,7 +640,7 @@ int mutt_convert_string(char **ps, const char *from, const char *to, int flags)
     ibl = strlen(s);
     if (ibl >= SIZE_MAX / MB_LEN_MAX)
     {
-      iconv_close(cd);
+      mutt_iconv_release(cd);
       return -1;
     }
 
@@ -513,7 +649,7 @@ int mutt_convert_string(char **ps, const char *from, const char *to, int flags)
 
     mutt_iconv(cd, &ib, &ibl, &ob, &obl, inrepls, outrepl);
     iconv(cd, 0, 0, &ob, &obl);
-    iconv_close(cd);
+    mutt_iconv_release(cd);
 
     *ob = '\0';
 
@@ -563,7 +699,7 @@ FGETCONV *fgetconv_open(FILE *file, const char *from, const char *to, int flags)
   static ICONV_CONST char *repls[] = { "\357\277\275", "?", 0 };
 
   if (from && to)
-    cd = mutt_iconv_open(to, from, flags);
+    cd = mutt_iconv_open_cached(to, from, flags);
 
   if (cd != (iconv_t)-1)
   {
@@ -659,7 +795,7 @@ void fgetconv_close(FGETCONV **_fc)
   struct fgetconv_s *fc = (struct fgetconv_s *) *_fc;
 
   if (fc->cd != (iconv_t)-1)
-    iconv_close(fc->cd);
+    mutt_iconv_release(fc->cd);
   FREE(_fc);           /* __FREE_CHECKED__ */
 }
 
@@ -40,6 +40,20 @@ COLOR_LINE *ColorIndexList = NULL;
 
 /* local to this file */
 static int ColorQuoteSize;
+
+/* The pager's prefilter for the body and header color patterns.  Patterns
+ * with a required literal are chained by its first letter, so that a line
+ * is scanned once for all of them, and the patterns whose literal isn't in
+ * the line are never handed to regexec(). */
+struct color_prefilter
+{
+  COLOR_LINE *list;             /* the list first[] was built for */
+  unsigned int gen;
+  COLOR_LINE *first[256];
+};
+
+static struct color_prefilter BodyPrefilter, HdrPrefilter;
+static unsigned int ColorListGen = 1;
 #if defined(HAVE_COLOR) && defined(HAVE_USE_DEFAULT_COLORS)
 static int HaveDefaultColors = 0;
 static int DefaultColorsInit = 0;
@@ -175,7 +189,70 @@ static void mutt_free_color_line(COLOR_LINE **l,
   regfree(&tmp->rx);
   mutt_pattern_free(&tmp->color_pattern);
   FREE(&tmp->pattern);
+  FREE(&tmp->literal);
   FREE(l);             /* __FREE_CHECKED__ */
+
+  ColorListGen++;
+}
+
+static void build_prefilter(struct color_prefilter *pf, COLOR_LINE *list)
+{
+  COLOR_LINE *c;
+  int i;
+
+  memset(pf->first, 0, sizeof(pf->first));
+  for (c = list; c; c = c->next)
+    if (c->literal)
+    {
+      i = tolower((unsigned char) *c->literal);
+      c->literal_next = pf->first[i];
+      pf->first[i] = c;
+    }
+  pf->list = list;
+  pf->gen = ColorListGen;
+}
+
+/* Resets the pager's matching state of the patterns in list, which is
+ * ColorBodyList or ColorHdrList, for the line s.  Patterns which can't
+ * match anywhere in s are marked with stop_matching. */
+void mutt_color_prefilter(COLOR_LINE *list, const char *s)
+{
+  struct color_prefilter *pf;
+  COLOR_LINE *c;
+  int pending = 0;
+
+  pf = (list == ColorHdrList) ? &HdrPrefilter : &BodyPrefilter;
+  if (pf->list != list || pf->gen != ColorListGen)
+    build_prefilter(pf, list);
+
+  for (c = list; c; c = c->next)
+  {
+    c->cached = 0;
+    c->stop_matching = 0;
+    if (c->literal)
+    {
+      c->stop_matching = 1;
+      pending++;
+    }
+  }
+
+  for (; *s && pending; s++)
+    for (c = pf->first[tolower((unsigned char) *s)]; c; c = c->literal_next)
+    {
+      if (!c->stop_matching)
+        continue;
+      if (c->literal_icase ?
+          !mutt_strncasecmp(s, c->literal, c->literal_len) :
+          !mutt_strncmp(s, c->literal, c->literal_len))
+      {
+        c->stop_matching = 0;
+        pending--;
+      }
+    }
+
+  for (c = list; c; c = c->next)
+    if (c->stop_matching)
+      c->prefilter_skips++;
 }
 
 #if defined(HAVE_COLOR) && defined(HAVE_USE_DEFAULT_COLORS)
@@ -794,11 +871,21 @@ add_pattern(COLOR_LINE **top, const char *s, int sensitive,
         return -1;
       }
     }
-    else if ((r = REGCOMP(&tmp->rx, s, (sensitive ? mutt_which_case(s) : REG_ICASE))) != 0)
+    else
     {
-      regerror(r, &tmp->rx, err->data, err->dsize);
-      mutt_free_color_line(&tmp, 1);
-      return (-1);
+      int flags = sensitive ? mutt_which_case(s) : REG_ICASE;
+
+      if ((r = REGCOMP(&tmp->rx, s, flags)) != 0)
+      {
+        regerror(r, &tmp->rx, err->data, err->dsize);
+        mutt_free_color_line(&tmp, 1);
+        return (-1);
+      }
+      if ((tmp->literal = mutt_regex_literal(s)))
+      {
+        tmp->literal_len = strlen(tmp->literal);
+        tmp->literal_icase = (flags & REG_ICASE) ? 1 : 0;
+      }
     }
     tmp->next = *top;
     tmp->pattern = safe_strdup(s);
@@ -812,6 +899,7 @@ add_pattern(COLOR_LINE **top, const char *s, int sensitive,
 #endif
     tmp->color.attrs = attr;
     *top = tmp;
+    ColorListGen++;
   }
 
   /* force re-caching of index colors */
@@ -127,7 +127,7 @@ static void process_protected_headers(HEADER *cur)
 
     mutt_str_replace(&cur->env->subject, prot_headers->subject);
     FREE(&cur->env->disp_subj);
-    if (regexec(ReplyRegexp.rx, cur->env->subject, 1, pmatch, 0) == 0)
+    if (mutt_regexec(&ReplyRegexp, cur->env->subject, 1, pmatch, 0) == 0)
       cur->env->real_subj = cur->env->subject + pmatch[0].rm_eo;
     else
       cur->env->real_subj = cur->env->subject;
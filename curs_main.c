@@ -208,12 +208,86 @@ void mutt_ts_icon(char *str)
   fprintf(stderr, "\033]1;%s\007", str);
 }
 
+/* Each HEADER keeps the last line index_make_entry() produced for it.
+ * The line is reused as long as the generation counter below hasn't moved
+ * and the window width, format flags and (for time dependent formats) the
+ * current second are the same.  Anything that may change the output of
+ * $index_format -- flag changes, sorting, threading, configuration
+ * commands and any index function other than plain movement -- bumps the
+ * generation.
+ */
+static unsigned int IndexLineGen = 1;
+static unsigned long IndexLineHits = 0, IndexLineMisses = 0;
+
+void mutt_invalidate_index_lines(void)
+{
+  if (!++IndexLineGen)
+    IndexLineGen = 1;
+}
+
+unsigned int mutt_index_lines_gen(void)
+{
+  return IndexLineGen;
+}
+
+/* functions which only move around the index and leave the cached lines
+ * valid */
+static int index_op_keeps_lines(int op)
+{
+  switch (op)
+  {
+    case -1:
+    case -2:
+    case OP_BOTTOM_PAGE:
+    case OP_FIRST_ENTRY:
+    case OP_MIDDLE_PAGE:
+    case OP_HALF_UP:
+    case OP_HALF_DOWN:
+    case OP_NEXT_LINE:
+    case OP_PREV_LINE:
+    case OP_NEXT_PAGE:
+    case OP_PREV_PAGE:
+    case OP_LAST_ENTRY:
+    case OP_TOP_PAGE:
+    case OP_CURRENT_TOP:
+    case OP_CURRENT_MIDDLE:
+    case OP_CURRENT_BOTTOM:
+    case OP_JUMP:
+    case OP_SEARCH:
+    case OP_SEARCH_REVERSE:
+    case OP_SEARCH_NEXT:
+    case OP_SEARCH_OPPOSITE:
+    case OP_NEXT_ENTRY:
+    case OP_PREV_ENTRY:
+    case OP_MAIN_NEXT_UNDELETED:
+    case OP_MAIN_PREV_UNDELETED:
+    case OP_MAIN_NEXT_NEW:
+    case OP_MAIN_NEXT_UNREAD:
+    case OP_MAIN_PREV_NEW:
+    case OP_MAIN_PREV_UNREAD:
+    case OP_MAIN_NEXT_NEW_THEN_UNREAD:
+    case OP_MAIN_PREV_NEW_THEN_UNREAD:
+    case OP_MAIN_NEXT_THREAD:
+    case OP_MAIN_NEXT_SUBTHREAD:
+    case OP_MAIN_PREV_THREAD:
+    case OP_MAIN_PREV_SUBTHREAD:
+    case OP_MAIN_ROOT_MESSAGE:
+    case OP_MAIN_PARENT_MESSAGE:
+      return 1;
+  }
+  return 0;
+}
+
 void index_make_entry(char *s, size_t l, MUTTMENU *menu, int num)
 {
   format_flag flag = MUTT_FORMAT_ARROWCURSOR | MUTT_FORMAT_INDEX;
   int edgemsgno, reverse = Sort & SORT_REVERSE;
   HEADER *h = Context->hdrs[Context->v2r[num]];
   THREAD *tmp;
+  time_t now;
+
+  if ((Sort & SORT_MASK) == SORT_THREADS)
+    mutt_draw_thread(Context, h);
 
   if ((Sort & SORT_MASK) == SORT_THREADS && h->tree)
   {
@@ -267,7 +341,28 @@ void index_make_entry(char *s, size_t l, MUTTMENU *menu, int num)
     }
   }
 
+  /* %<...> and index-format-hook patterns may depend on the current time */
+  now = strpbrk(NONULL(HdrFmt), "<@") ? time(NULL) : 0;
+
+  if (h->index_line &&
+      h->index_line_gen == IndexLineGen &&
+      h->index_line_cols == MuttIndexWindow->cols &&
+      h->index_line_flags == flag &&
+      h->index_line_time == now)
+  {
+    IndexLineHits++;
+    strfcpy(s, h->index_line, l);
+    return;
+  }
+
+  IndexLineMisses++;
   _mutt_make_string(s, l, NONULL(HdrFmt), Context, h, flag);
+
+  mutt_str_replace(&h->index_line, s);
+  h->index_line_gen = IndexLineGen;
+  h->index_line_cols = MuttIndexWindow->cols;
+  h->index_line_flags = flag;
+  h->index_line_time = now;
 }
 
 COLOR_ATTR index_color(int index_no)
@@ -444,7 +539,9 @@ static void update_index_threaded(CONTEXT *ctx, int check, int oldcount)
       }
       mutt_set_virtual(ctx);
     }
-    else if (oldcount)
+    /* headers backfilled by $imap_fetch_newest are passed as MUTT_FLAGS:
+     * they are old mail, so leave their threads alone */
+    else if (oldcount && check != MUTT_FLAGS)
     {
       for (j = 0; j < ctx->msgcount - oldcount; j++)
         if (!ctx->pattern || save_new[j]->limited)
@@ -500,6 +597,8 @@ static void update_index(MUTTMENU *menu, CONTEXT *ctx, int check,
 {
   int j;
 
+  mutt_invalidate_index_lines();
+
   /* for purposes of updating the index, MUTT_RECONNECTED is the same */
   if (check == MUTT_RECONNECTED)
     check = MUTT_REOPENED;
@@ -674,6 +773,10 @@ int mutt_index_menu(void)
     if (tag && op != OP_TAG_PREFIX && op != OP_TAG_PREFIX_COND && op != -2)
       tag = 0;
 
+    /* the previous function may have changed what the index shows */
+    if (!index_op_keeps_lines(op))
+      mutt_invalidate_index_lines();
+
     /* check if we need to resort the index because just about
      * any 'op' below could do mutt_enter_command(), either here or
      * from any new menu launched, and change $sort/$sort_aux
@@ -751,6 +854,24 @@ int mutt_index_menu(void)
 
         set_option(OPTSEARCHINVALID);
       }
+#ifdef USE_IMAP
+      /* while idle, fetch more of a mailbox opened with $imap_fetch_newest */
+      else if (op == -2 && imap_backfill_pending(Context))
+      {
+        HEADER *cur = (Context->vcount && menu->current >= 0 &&
+                       menu->current < Context->vcount) ? CURHDR : NULL;
+
+        if (imap_backfill_headers(Context) > 0)
+        {
+          /* mailbox order was renumbered, so look up the hint afterwards */
+          update_index(menu, Context, MUTT_FLAGS, oldcount,
+                       cur ? cur->index : 0);
+          menu->redraw |= REDRAW_INDEX | REDRAW_STATUS;
+          menu->max = Context->vcount;
+          set_option(OPTSEARCHINVALID);
+        }
+      }
+#endif
     }
 
     if (!attach_msg)
@@ -2712,6 +2833,10 @@ int mutt_index_menu(void)
     if (done) break;
   }
 
+  muttdbg(2, "index line cache: %lu hits, %lu misses",
+          IndexLineHits, IndexLineMisses);
+  mutt_log_regexec_stats();
+
   mutt_pop_current_menu(menu);
   mutt_menuDestroy(&menu);
   return (close);
@@ -40,6 +40,9 @@
 # ifndef USE_HCACHE
 #  define USE_HCACHE
 # endif
+# ifndef USE_INOTIFY
+#  define USE_INOTIFY
+# endif
 # ifndef HAVE_DB4
 #  define HAVE_DB4
 # endif
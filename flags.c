@@ -26,6 +26,10 @@
 #include "sort.h"
 #include "mx.h"
 
+#ifdef USE_IMAP
+#include "imap.h"
+#endif
+
 void _mutt_set_flag(CONTEXT *ctx, HEADER *h, int flag, int bf, int upd_flags)
 {
   int changed = h->changed;
@@ -271,10 +275,16 @@ void _mutt_set_flag(CONTEXT *ctx, HEADER *h, int flag, int bf, int upd_flags)
       break;
   }
 
+#ifdef USE_IMAP
+  if (h->changed && ctx->magic == MUTT_IMAP)
+    imap_set_dirty(ctx, h);
+#endif
+
   if (update)
   {
     h->color.pair = 0;
     h->color.attrs = 0;
+    mutt_invalidate_index_lines();
 #ifdef USE_SIDEBAR
     mutt_set_current_menu_redraw(REDRAW_SIDEBAR);
 #endif
@@ -237,6 +237,7 @@ WHERE short HistSize;
 WHERE short MenuContext;
 WHERE short PagerContext;
 WHERE short PagerIndexLines;
+WHERE short PagerReadAhead;
 WHERE short PagerSkipQuotedContext;
 WHERE short ReadInc;
 WHERE short ReflowWrap;
@@ -260,6 +261,7 @@ WHERE LIST *SidebarWhitelist;
 
 #ifdef USE_IMAP
 WHERE long  ImapFetchChunkSize;
+WHERE short ImapFetchNewest;
 WHERE short ImapKeepalive;
 WHERE short ImapPipelineDepth;
 WHERE short ImapPollTimeout;
@@ -66,15 +66,6 @@ const int Index_64[128] = {
   41,42,43,44, 45,46,47,48, 49,50,51,-1, -1,-1,-1,-1
 };
 
-static void state_prefix_put(const char *d, size_t dlen, STATE *s)
-{
-  if (s->prefix)
-    while (dlen--)
-      state_prefix_putc(*d++, s);
-  else
-    fwrite(d, dlen, 1, s->fpout);
-}
-
 static void mutt_convert_to_state(iconv_t cd, char *bufi, size_t *l, STATE *s)
 {
   char bufo[BUFO_SIZE];
@@ -116,31 +107,34 @@ static void mutt_convert_to_state(iconv_t cd, char *bufi, size_t *l, STATE *s)
 
 static void mutt_decode_xbit(STATE *s, LOFF_T len, int istext, iconv_t cd)
 {
-  int c, ch;
+  char bufr[BUFI_SIZE];
   char bufi[BUFI_SIZE];
-  size_t l = 0;
+  size_t l = 0, n, i;
+  int cr = 0;
 
   if (istext)
   {
     state_set_prefix(s);
 
-    while ((c = fgetc(s->fpin)) != EOF && len--)
+    /* turn CRLF into LF, reading a block at a time */
+    while (len > 0 &&
+           (n = fread(bufr, 1, MIN((LOFF_T) sizeof(bufr), len), s->fpin)) > 0)
     {
-      if (c == '\r' && len)
+      len -= n;
+      for (i = 0; i < n; i++)
       {
-        if ((ch = fgetc(s->fpin)) == '\n')
-        {
-          c = ch;
-          len--;
-        }
-        else
-          ungetc(ch, s->fpin);
+        if (l + 2 > sizeof(bufi))
+          mutt_convert_to_state(cd, bufi, &l, s);
+
+        if (cr && bufr[i] != '\n')
+          bufi[l++] = '\r';
+        cr = (bufr[i] == '\r');
+        if (!cr)
+          bufi[l++] = bufr[i];
       }
-
-      bufi[l++] = c;
-      if (l == sizeof(bufi))
-        mutt_convert_to_state(cd, bufi, &l, s);
     }
+    if (cr)
+      bufi[l++] = '\r';
 
     mutt_convert_to_state(cd, bufi, &l, s);
     mutt_convert_to_state(cd, 0, 0, s);
@@ -183,6 +177,18 @@ static void qp_decode_line(char *dest, char *src, size_t *l,
 
   for (d = dest, s = src; *s;)
   {
+    /* copy a run of literal characters in one go */
+    if (*s != '=')
+    {
+      size_t run = strcspn(s, "=");
+
+      memcpy(d, s, run);
+      d += run;
+      s += run;
+      kind = -1;
+      continue;
+    }
+
     switch ((kind = qp_decode_triple(s, &c)))
     {
       case  0: *d++ = c; s += 3; break; /* qp triple */
@@ -286,78 +292,108 @@ static void mutt_decode_quoted(STATE *s, LOFF_T len, int istext, iconv_t cd)
 
 void mutt_decode_base64(STATE *s, LOFF_T len, int istext, iconv_t cd)
 {
-  char buf[5];
-  int c1, c2, c3, c4, ch, cr = 0, i;
+  char buf[4], out[3];
+  char bufr[BUFI_SIZE];
+  int c1, c2, c3, c4, cr = 0, i = 0, done = 0;
+  size_t n = 0, pos = 0, outlen, j;
   char bufi[BUFI_SIZE];
   size_t l = 0;
 
-  buf[4] = 0;
-
   if (istext)
     state_set_prefix(s);
 
-  while (len > 0)
+  /* Read the input a block at a time instead of with fgetc(), and
+   * decode each group of four as soon as it is complete. */
+  while (!done && len > 0)
   {
-    for (i = 0 ; i < 4 && len > 0 ; len--)
-    {
-      if ((ch = fgetc(s->fpin)) == EOF)
-        break;
-      if (ch >= 0 && ch < 128 && (base64val(ch) != -1 || ch == '='))
-        buf[i++] = ch;
-    }
-    if (i != 4)
-    {
-      /* "i" may be zero if there is trailing whitespace, which is not an error */
-      if (i != 0)
-        muttdbg(2, "didn't get a multiple of 4 chars.");
-      break;
-    }
-
-    c1 = base64val(buf[0]);
-    c2 = base64val(buf[1]);
-    ch = (c1 << 2) | (c2 >> 4);
-
-    if (cr && ch != '\n')
-      bufi[l++] = '\r';
-
-    cr = 0;
-
-    if (istext && ch == '\r')
-      cr = 1;
-    else
-      bufi[l++] = ch;
-
-    if (buf[2] == '=')
+    n = fread(bufr, 1, MIN((LOFF_T) sizeof(bufr), len), s->fpin);
+    if (!n)
       break;
-    c3 = base64val(buf[2]);
-    ch = ((c2 & 0xf) << 4) | (c3 >> 2);
+    len -= n;
 
-    if (cr && ch != '\n')
-      bufi[l++] = '\r';
+    for (pos = 0; pos < n; pos++)
+    {
+      unsigned char ch = (unsigned char) bufr[pos];
+
+      /* fast path: a whole group of four plain base64 characters */
+      if (!i && !istext && pos + 4 <= n &&
+          !((bufr[pos] | bufr[pos+1] | bufr[pos+2] | bufr[pos+3]) & 0x80) &&
+          (c1 = base64val(bufr[pos])) != -1 &&
+          (c2 = base64val(bufr[pos+1])) != -1 &&
+          (c3 = base64val(bufr[pos+2])) != -1 &&
+          (c4 = base64val(bufr[pos+3])) != -1)
+      {
+        bufi[l++] = (c1 << 2) | (c2 >> 4);
+        bufi[l++] = ((c2 & 0xf) << 4) | (c3 >> 2);
+        bufi[l++] = ((c3 & 0x3) << 6) | c4;
+        pos += 3;
+        if (l + 8 >= sizeof(bufi))
+          mutt_convert_to_state(cd, bufi, &l, s);
+        continue;
+      }
 
-    cr = 0;
+      if (ch >= 128 || (base64val(ch) == -1 && ch != '='))
+        continue;
+      buf[i++] = ch;
+      if (i < 4)
+        continue;
+      i = 0;
+
+      c1 = base64val(buf[0]);
+      c2 = base64val(buf[1]);
+      out[0] = (c1 << 2) | (c2 >> 4);
+      outlen = 1;
+      if (buf[2] != '=')
+      {
+        c3 = base64val(buf[2]);
+        out[1] = ((c2 & 0xf) << 4) | (c3 >> 2);
+        outlen = 2;
+        if (buf[3] != '=')
+        {
+          c4 = base64val(buf[3]);
+          out[2] = ((c3 & 0x3) << 6) | c4;
+          outlen = 3;
+        }
+      }
 
-    if (istext && ch == '\r')
-      cr = 1;
-    else
-      bufi[l++] = ch;
+      if (!istext)
+      {
+        for (j = 0; j < outlen; j++)
+          bufi[l++] = out[j];
+      }
+      else
+      {
+        /* turn CRLF into LF */
+        for (j = 0; j < outlen; j++)
+        {
+          if (cr && out[j] != '\n')
+            bufi[l++] = '\r';
+          cr = (out[j] == '\r');
+          if (!cr)
+            bufi[l++] = out[j];
+        }
+      }
 
-    if (buf[3] == '=') break;
-    c4 = base64val(buf[3]);
-    ch = ((c3 & 0x3) << 6) | c4;
+      if (outlen < 3)
+      {
+        done = 1;
+        pos++;
+        break;
+      }
 
-    if (cr && ch != '\n')
-      bufi[l++] = '\r';
-    cr = 0;
+      if (l + 8 >= sizeof(bufi))
+        mutt_convert_to_state(cd, bufi, &l, s);
+    }
+  }
 
-    if (istext && ch == '\r')
-      cr = 1;
-    else
-      bufi[l++] = ch;
+  /* "i" may be zero if there is trailing whitespace, which is not an error */
+  if (!done && i != 0)
+    muttdbg(2, "didn't get a multiple of 4 chars.");
 
-    if (l + 8 >= sizeof(bufi))
-      mutt_convert_to_state(cd, bufi, &l, s);
-  }
+  /* leave the stream just after the padding, as reading a character at
+   * a time did */
+  if (done && pos < n)
+    fseeko(s->fpin, -(LOFF_T) (n - pos), SEEK_CUR);
 
   if (cr) bufi[l++] = '\r';
 
@@ -1559,10 +1595,10 @@ void mutt_decode_attachment(const BODY *b, STATE *s)
     if (!charset && AssumedCharset)
       charset = mutt_get_default_charset();
     if (charset && Charset)
-      cd = mutt_iconv_open(Charset, charset, MUTT_ICONV_HOOK_FROM);
+      cd = mutt_iconv_open_cached(Charset, charset, MUTT_ICONV_HOOK_FROM);
   }
   else if (istext && b->charset)
-    cd = mutt_iconv_open(Charset, b->charset, MUTT_ICONV_HOOK_FROM);
+    cd = mutt_iconv_open_cached(Charset, b->charset, MUTT_ICONV_HOOK_FROM);
 
   fseeko(s->fpin, b->offset, SEEK_SET);
   switch (b->encoding)
@@ -1581,8 +1617,7 @@ void mutt_decode_attachment(const BODY *b, STATE *s)
       break;
   }
 
-  if (cd != (iconv_t)(-1))
-    iconv_close(cd);
+  mutt_iconv_release(cd);
 }
 
 /* when generating format=flowed ($text_flowed is set) from format=fixed,
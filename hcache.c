@@ -729,6 +729,8 @@ mutt_hcache_dump(header_cache_t *h, HEADER * header, int *off,
   nh.path = NULL;
   nh.tree = NULL;
   nh.thread = NULL;
+  nh.index_line = NULL;
+  nh.index_line_gen = 0;
 #ifdef MIXMASTER
   nh.chain = NULL;
 #endif
@@ -28,6 +28,11 @@
 #include "compress.h"
 #endif
 
+#ifdef USE_IMAP
+#include "mx.h"
+#include "imap.h"
+#endif
+
 #include <limits.h>
 #include <string.h>
 #include <stdlib.h>
@@ -52,7 +57,7 @@ int mutt_parse_hook(BUFFER *buf, BUFFER *s, union pointer_long_t udata, BUFFER *
 {
   HOOK *ptr;
   BUFFER *command, *pattern;
-  int rc = -1, not = 0, token_flags = 0;
+  int rc = -1, not = 0, token_flags = 0, rx_flags = 0;
   regex_t *rx = NULL;
   pattern_t *pat = NULL;
   long data = udata.l;
@@ -230,15 +235,16 @@ int mutt_parse_hook(BUFFER *buf, BUFFER *s, union pointer_long_t udata, BUFFER *
     /* Hooks not allowing full patterns: Check syntax of regexp */
     rx = safe_malloc(sizeof(regex_t));
 #ifdef MUTT_CRYPTHOOK
-    if ((rv = REGCOMP(rx, mutt_b2s(pattern), ((data & (MUTT_CRYPTHOOK|MUTT_CHARSETHOOK|MUTT_ICONVHOOK)) ? REG_ICASE : 0))) != 0)
+    rx_flags = (data & (MUTT_CRYPTHOOK|MUTT_CHARSETHOOK|MUTT_ICONVHOOK)) ? REG_ICASE : 0;
 #else
-      if ((rv = REGCOMP(rx, mutt_b2s(pattern), (data & (MUTT_CHARSETHOOK|MUTT_ICONVHOOK)) ? REG_ICASE : 0)) != 0)
+    rx_flags = (data & (MUTT_CHARSETHOOK|MUTT_ICONVHOOK)) ? REG_ICASE : 0;
 #endif /* MUTT_CRYPTHOOK */
-      {
-        regerror(rv, rx, err->data, err->dsize);
-        FREE(&rx);
-        goto cleanup;
-      }
+    if ((rv = REGCOMP(rx, mutt_b2s(pattern), rx_flags)) != 0)
+    {
+      regerror(rv, rx, err->data, err->dsize);
+      FREE(&rx);
+      goto cleanup;
+    }
   }
 
   if (ptr)
@@ -254,6 +260,8 @@ int mutt_parse_hook(BUFFER *buf, BUFFER *s, union pointer_long_t udata, BUFFER *
   ptr->rx.pattern = safe_strdup(mutt_b2s(pattern));
   ptr->rx.rx = rx;
   ptr->rx.not = not;
+  if (rx)
+    mutt_set_regexp_literal(&ptr->rx, mutt_b2s(pattern), rx_flags);
 
   rc = 0;
 
@@ -267,6 +275,7 @@ static void delete_hook(HOOK *h)
 {
   FREE(&h->command);
   FREE(&h->rx.pattern);
+  FREE(&h->rx.literal);
   if (h->rx.rx)
   {
     regfree(h->rx.rx);
@@ -478,7 +487,7 @@ void mutt_folder_hook(const char *path)
 
     if (tmp->type & MUTT_FOLDERHOOK)
     {
-      if ((regexec(tmp->rx.rx, path, 0, NULL, 0) == 0) ^ tmp->rx.not)
+      if ((mutt_regexec(&tmp->rx, path, 0, NULL, 0) == 0) ^ tmp->rx.not)
       {
         if (mutt_parse_rc_line(tmp->command, &err) == -1)
         {
@@ -504,12 +513,22 @@ char *mutt_find_hook(int type, const char *pat)
   for (; tmp; tmp = tmp->next)
     if (tmp->type & type)
     {
-      if (regexec(tmp->rx.rx, pat, 0, NULL, 0) == 0)
+      if (mutt_regexec(&tmp->rx, pat, 0, NULL, 0) == 0)
         return (tmp->command);
     }
   return (NULL);
 }
 
+/* Hook patterns and the save defaults can look at any header field, so
+ * fetch the ones $imap_lazy_headers left out before matching. */
+static void hook_complete_headers(CONTEXT *ctx, HEADER *hdr)
+{
+#ifdef USE_IMAP
+  if (ctx && ctx->magic == MUTT_IMAP && hdr && hdr->env_partial)
+    imap_complete_headers(ctx, hdr, 0);
+#endif
+}
+
 void mutt_message_hook(CONTEXT *ctx, HEADER *hdr, int type)
 {
   BUFFER err;
@@ -518,6 +537,8 @@ void mutt_message_hook(CONTEXT *ctx, HEADER *hdr, int type)
 
   current_hook_type = type;
 
+  hook_complete_headers(ctx, hdr);
+
   mutt_buffer_init(&err);
   err.dsize = STRING;
   err.data = safe_malloc(err.dsize);
@@ -555,6 +576,8 @@ mutt_addr_hook(char *path, size_t pathlen, int type, CONTEXT *ctx, HEADER *hdr)
   HOOK *hook;
   pattern_cache_t cache;
 
+  hook_complete_headers(ctx, hdr);
+
   memset(&cache, 0, sizeof(cache));
   /* determine if a matching hook exists */
   for (hook = Hooks; hook; hook = hook->next)
@@ -640,7 +663,7 @@ static char *_mutt_string_hook(const char *match, int hook)
   for (; tmp; tmp = tmp->next)
   {
     if ((tmp->type & hook) &&
-        ((match && regexec(tmp->rx.rx, match, 0, NULL, 0) == 0) ^ tmp->rx.not))
+        ((match && mutt_regexec(&tmp->rx, match, 0, NULL, 0) == 0) ^ tmp->rx.not))
       return (tmp->command);
   }
   return (NULL);
@@ -654,7 +677,7 @@ static LIST *_mutt_list_hook(const char *match, int hook)
   for (; tmp; tmp = tmp->next)
   {
     if ((tmp->type & hook) &&
-        ((match && regexec(tmp->rx.rx, match, 0, NULL, 0) == 0) ^ tmp->rx.not))
+        ((match && mutt_regexec(&tmp->rx, match, 0, NULL, 0) == 0) ^ tmp->rx.not))
       matches = mutt_add_list(matches, tmp->command);
   }
   return (matches);
@@ -698,7 +721,7 @@ void mutt_account_hook(const char *url)
     if (! (hook->command && (hook->type & MUTT_ACCOUNTHOOK)))
       continue;
 
-    if ((regexec(hook->rx.rx, url, 0, NULL, 0) == 0) ^ hook->rx.not)
+    if ((mutt_regexec(&hook->rx, url, 0, NULL, 0) == 0) ^ hook->rx.not)
     {
       inhook = 1;
 
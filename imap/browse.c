@@ -64,7 +64,7 @@ int imap_browse(const char *path, struct browser_state *state)
   save_lsub = option(OPTIMAPCHECKSUBSCRIBED);
   unset_option(OPTIMAPCHECKSUBSCRIBED);
 
-  if (!(idata = imap_conn_find(&(mx.account), 0)))
+  if (!(idata = imap_conn_find(&(mx.account), MUTT_IMAP_CONN_POLL)))
     goto fail;
 
   if (option(OPTIMAPLSUB))
@@ -420,7 +420,7 @@ static void imap_add_folder(char delim, char *folder, int noselect,
   /* apply filemask filter. This should really be done at menu setup rather
    * than at scan, since it's so expensive to scan. But that's big changes
    * to browser.c */
-  if (!((regexec(Mask.rx, relpath, 0, NULL, 0) == 0) ^ Mask.not))
+  if (!((mutt_regexec(&Mask, relpath, 0, NULL, 0) == 0) ^ Mask.not))
   {
     FREE(&mx.mbox);
     return;
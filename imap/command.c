@@ -48,6 +48,10 @@ static int cmd_handle_untagged(IMAP_DATA *idata);
 static void cmd_parse_capability(IMAP_DATA *idata, char *s);
 static void cmd_parse_vanished(IMAP_DATA *idata, char *s);
 static void cmd_parse_expunge(IMAP_DATA *idata, const char *s);
+static int cmd_is_expunge(const char *s);
+static void cmd_msn_tree_start(IMAP_DATA *idata);
+static unsigned int cmd_msn_tree_find(IMAP_DATA *idata, unsigned int msn);
+static void cmd_msn_tree_remove(IMAP_DATA *idata, unsigned int slot);
 static void cmd_parse_list(IMAP_DATA *idata, char *s);
 static void cmd_parse_lsub(IMAP_DATA *idata, char *s);
 static void cmd_parse_fetch(IMAP_DATA *idata, char *s);
@@ -76,6 +80,7 @@ static const char * const Capabilities[] = {
   "QRESYNC",
   "LIST-EXTENDED",
   "COMPRESS=DEFLATE",
+  "NOTIFY",
 
   NULL
 };
@@ -144,6 +149,11 @@ int imap_cmd_step(IMAP_DATA *idata)
 
   idata->lastread = time(NULL);
 
+  /* Runs of EXPUNGE responses leave msn_index uncompacted.  Anything
+   * else may look at it, so squeeze out the holes first. */
+  if (idata->msn_tree_len && !cmd_is_expunge(idata->buf))
+    imap_msn_index_compact(idata);
+
   /* handle untagged messages. The caller still gets its shot afterwards. */
   if ((!ascii_strncmp(idata->buf, "* ", 2)
        || !ascii_strncmp(imap_next_word(idata->buf), "OK [", 4))
@@ -306,6 +316,8 @@ void imap_cmd_finish(IMAP_DATA *idata)
     return;
   }
 
+  imap_msn_index_compact(idata);
+
   if (!(idata->state >= IMAP_SELECTED) || idata->ctx->closing)
     return;
 
@@ -372,6 +384,79 @@ int imap_cmd_idle(IMAP_DATA *idata)
   return 0;
 }
 
+/* imap_cmd_outstanding: returns the number of commands which haven't
+ * received their tagged completion response yet. */
+int imap_cmd_outstanding(IMAP_DATA *idata)
+{
+  int c, n = 0;
+
+  for (c = idata->lastcmd; c != idata->nextcmd; c = (c + 1) % idata->cmdslots)
+    if (idata->cmds[c].state == IMAP_CMD_NEW)
+      n++;
+
+  return n;
+}
+
+/* imap_cmd_pump: handle the responses already waiting on the connection,
+ * without blocking for more.  This is used to collect the results of
+ * commands which were sent with imap_cmd_start() and not waited for.
+ * Returns 0 on success, -1 on error. */
+int imap_cmd_pump(IMAP_DATA *idata)
+{
+  int rc;
+
+  while ((rc = mutt_socket_poll(idata->conn, 0)) > 0)
+  {
+    if (imap_cmd_step(idata) == IMAP_CMD_BAD)
+      return -1;
+  }
+
+  imap_msn_index_compact(idata);
+
+  return rc < 0 ? -1 : 0;
+}
+
+/* imap_msn_index_compact: apply the EXPUNGEs received since the last
+ * call to msn_index, renumbering the surviving headers.  This is a
+ * single O(n) pass no matter how many messages were expunged. */
+void imap_msn_index_compact(IMAP_DATA *idata)
+{
+  unsigned int len = idata->msn_tree_len;
+  unsigned int *tree = idata->msn_tree;
+  unsigned int i, j, msn = 0;
+  HEADER *h;
+
+  if (!len)
+    return;
+
+  /* turn the Fenwick tree back into per-slot live counts */
+  for (i = len; i > 0; i--)
+  {
+    j = i + (i & -i);
+    if (j <= len)
+      tree[j] -= tree[i];
+  }
+
+  for (i = 1; i <= len; i++)
+  {
+    if (!tree[i])
+      continue;
+
+    h = idata->msn_index[i - 1];
+    idata->msn_index[msn++] = h;
+    if (h)
+      HEADER_DATA(h)->msn = msn;
+  }
+
+  for (i = msn; i < len; i++)
+    idata->msn_index[i] = NULL;
+
+  if (msn != idata->max_msn)
+    muttdbg(1, "msn_index compacted to %u, expected %u", msn, idata->max_msn);
+
+  idata->msn_tree_len = 0;
+}
+
 static int cmd_queue_full(IMAP_DATA *idata)
 {
   if ((idata->nextcmd + 1) % idata->cmdslots == idata->lastcmd)
@@ -442,6 +527,8 @@ static int cmd_start(IMAP_DATA *idata, const char *cmdstr, int flags)
   if (cmdstr && ((rc = cmd_queue(idata, cmdstr, flags)) < 0))
     return rc;
 
+  imap_msn_index_compact(idata);
+
   if (flags & IMAP_CMD_QUEUE)
     return 0;
 
@@ -640,10 +727,13 @@ static void cmd_parse_capability(IMAP_DATA *idata, char *s)
 }
 
 /* cmd_parse_expunge: mark headers with new sequence ID and mark idata to
- *   be reopened at our earliest convenience */
+ *   be reopened at our earliest convenience.  The headers above the
+ *   expunged one are renumbered later by imap_msn_index_compact(), so a
+ *   run of EXPUNGEs costs O(log n) each instead of shifting msn_index
+ *   every time. */
 static void cmd_parse_expunge(IMAP_DATA *idata, const char *s)
 {
-  unsigned int exp_msn, cur;
+  unsigned int exp_msn, slot;
   HEADER *h;
 
   muttdbg(2, "Handling EXPUNGE");
@@ -652,7 +742,10 @@ static void cmd_parse_expunge(IMAP_DATA *idata, const char *s)
       exp_msn < 1 || exp_msn > idata->max_msn)
     return;
 
-  h = idata->msn_index[exp_msn - 1];
+  cmd_msn_tree_start(idata);
+  slot = cmd_msn_tree_find(idata, exp_msn);
+
+  h = idata->msn_index[slot - 1];
   if (h)
   {
     /* imap_expunge_mailbox() will rewrite h->index.
@@ -662,19 +755,82 @@ static void cmd_parse_expunge(IMAP_DATA *idata, const char *s)
     HEADER_DATA(h)->msn = 0;
   }
 
-  /* decrement seqno of those above. */
-  for (cur = exp_msn; cur < idata->max_msn; cur++)
+  idata->msn_index[slot - 1] = NULL;
+  cmd_msn_tree_remove(idata, slot);
+  idata->max_msn--;
+
+  idata->reopen |= IMAP_EXPUNGE_PENDING;
+}
+
+/* cmd_is_expunge: returns 1 if s is an untagged EXPUNGE or VANISHED
+ *   response, which can be applied without compacting msn_index. */
+static int cmd_is_expunge(const char *s)
+{
+  if (ascii_strncmp(s, "* ", 2))
+    return 0;
+  s += 2;
+
+  if (isdigit((unsigned char) *s))
+    return !ascii_strncasecmp("EXPUNGE", imap_next_word((char *) s), 7);
+
+  return !ascii_strncasecmp("VANISHED", s, 8);
+}
+
+/* cmd_msn_tree_start: at the start of a run of expunges, build a Fenwick
+ *   tree marking every msn_index slot as live.  While it exists, slots
+ *   keep their position and HEADER_DATA(h)->msn still names the slot. */
+static void cmd_msn_tree_start(IMAP_DATA *idata)
+{
+  unsigned int len = idata->max_msn;
+  unsigned int i, j;
+
+  if (idata->msn_tree_len)
+    return;
+
+  if (len + 1 > idata->msn_tree_size)
   {
-    h = idata->msn_index[cur];
-    if (h)
-      HEADER_DATA(h)->msn--;
-    idata->msn_index[cur - 1] = h;
+    safe_realloc(&idata->msn_tree, sizeof(unsigned int) * (len + 1));
+    idata->msn_tree_size = len + 1;
   }
 
-  idata->msn_index[idata->max_msn - 1] = NULL;
-  idata->max_msn--;
+  for (i = 1; i <= len; i++)
+    idata->msn_tree[i] = 1;
+  for (i = 1; i <= len; i++)
+  {
+    j = i + (i & -i);
+    if (j <= len)
+      idata->msn_tree[j] += idata->msn_tree[i];
+  }
 
-  idata->reopen |= IMAP_EXPUNGE_PENDING;
+  idata->msn_tree_len = len;
+}
+
+/* cmd_msn_tree_find: returns the msn_index slot (1-based) currently
+ *   holding message number msn. */
+static unsigned int cmd_msn_tree_find(IMAP_DATA *idata, unsigned int msn)
+{
+  unsigned int len = idata->msn_tree_len;
+  unsigned int pos = 0, step = 1;
+
+  while ((step << 1) <= len)
+    step <<= 1;
+
+  for (; step; step >>= 1)
+  {
+    if (pos + step <= len && idata->msn_tree[pos + step] < msn)
+    {
+      pos += step;
+      msn -= idata->msn_tree[pos];
+    }
+  }
+
+  return pos + 1;
+}
+
+static void cmd_msn_tree_remove(IMAP_DATA *idata, unsigned int slot)
+{
+  for (; slot <= idata->msn_tree_len; slot += slot & -slot)
+    idata->msn_tree[slot]--;
 }
 
 /* cmd_parse_vanished: handles VANISHED (RFC 7162), which is like
@@ -685,7 +841,7 @@ static void cmd_parse_vanished(IMAP_DATA *idata, char *s)
   int earlier = 0, rc;
   char *end_of_seqset;
   SEQSET_ITERATOR *iter;
-  unsigned int uid, exp_msn, cur;
+  unsigned int uid, exp_msn;
   HEADER *h;
 
   muttdbg(2, "Handling VANISHED");
@@ -728,7 +884,9 @@ static void cmd_parse_vanished(IMAP_DATA *idata, char *s)
     h->index = INT_MAX;
     HEADER_DATA(h)->msn = 0;
 
-    if (exp_msn < 1 || exp_msn > idata->max_msn)
+    /* During a run of expunges, the header's msn is its msn_index slot. */
+    if (exp_msn < 1 ||
+        exp_msn > (idata->msn_tree_len ? idata->msn_tree_len : idata->max_msn))
     {
       muttdbg(1, "msn for UID %u is incorrect.", uid);
       continue;
@@ -743,16 +901,8 @@ static void cmd_parse_vanished(IMAP_DATA *idata, char *s)
 
     if (!earlier)
     {
-      /* decrement seqno of those above. */
-      for (cur = exp_msn; cur < idata->max_msn; cur++)
-      {
-        h = idata->msn_index[cur];
-        if (h)
-          HEADER_DATA(h)->msn--;
-        idata->msn_index[cur - 1] = h;
-      }
-
-      idata->msn_index[idata->max_msn - 1] = NULL;
+      cmd_msn_tree_start(idata);
+      cmd_msn_tree_remove(idata, exp_msn);
       idata->max_msn--;
     }
   }
@@ -1128,6 +1278,8 @@ static void cmd_parse_status(IMAP_DATA *idata, char *s)
   unsigned int litlen;
   short new = 0;
   short new_msg_count = 0;
+  short new_unseen = 0;
+  short solicited;
 
   mailbox = imap_next_word(s);
 
@@ -1163,6 +1315,12 @@ static void cmd_parse_status(IMAP_DATA *idata, char *s)
   olduv = status->uidvalidity;
   oldun = status->uidnext;
 
+  /* answers to our own STATUS commands come first, NOTIFY updates can't
+   * be told from them by their contents */
+  solicited = status->status_sent > 0;
+  if (solicited)
+    status->status_sent--;
+
   if (*s++ != '(')
   {
     muttdbg(1, "Error parsing STATUS");
@@ -1194,7 +1352,10 @@ static void cmd_parse_status(IMAP_DATA *idata, char *s)
     else if (!ascii_strncmp("UIDVALIDITY", s, 11))
       status->uidvalidity = count;
     else if (!ascii_strncmp("UNSEEN", s, 6))
+    {
       status->unseen = count;
+      new_unseen = 1;
+    }
 
     s = value;
     if (*s && *s != ')')
@@ -1211,6 +1372,19 @@ static void cmd_parse_status(IMAP_DATA *idata, char *s)
     return;
   }
 
+  /* NOTIFY updates for unselected mailboxes don't include UNSEEN, which
+   * the new mail check below relies on.  Leave the comparison values
+   * alone and let imap_buffy_check() ask for the full status instead. */
+  if (idata->notify && !solicited && !new_unseen)
+  {
+    muttdbg(3, "NOTIFY: %s changed", status->name);
+    status->uidnext = oldun;
+    status->uidvalidity = olduv;
+    status->notify_changed = 1;
+    return;
+  }
+  status->notify_changed = 0;
+
   muttdbg(3, "Running default STATUS handler");
 
   /* should perhaps move this code back to imap_buffy_check */
@@ -46,6 +46,7 @@
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -253,6 +254,58 @@ int imap_read_literal(FILE *fp, IMAP_DATA *idata, unsigned int bytes, progress_t
   return 0;
 }
 
+/* imap_read_literal_buffer: read bytes bytes from server into dest,
+ *   replacing its contents and stripping \r from \r\n like
+ *   imap_read_literal(). */
+int imap_read_literal_buffer(BUFFER *dest, IMAP_DATA *idata, unsigned int bytes)
+{
+  unsigned int pos;
+  char *p;
+  char c;
+  int r = 0;
+
+  muttdbg(2, "imap_read_literal_buffer: reading %u bytes", bytes);
+
+  mutt_buffer_clear(dest);
+  mutt_buffer_increase_size(dest, (size_t) bytes + 1);
+  p = dest->data;
+
+  for (pos = 0; pos < bytes; pos++)
+  {
+    if (mutt_socket_readchar(idata->conn, &c) != 1)
+    {
+      muttdbg(1, "imap_read_literal_buffer: error during read, %u bytes read", pos);
+      idata->status = IMAP_FATAL;
+      *p = '\0';
+      dest->dptr = p;
+
+      return -1;
+    }
+
+    if (r == 1 && c != '\n')
+      *p++ = '\r';
+
+    if (c == '\r')
+    {
+      r = 1;
+      continue;
+    }
+    else
+      r = 0;
+
+    *p++ = c;
+  }
+
+  *p = '\0';
+  dest->dptr = p;
+#ifdef DEBUG
+  if (debuglevel >= IMAP_LOG_LTRL)
+    fputs(dest->data, debugfile);
+#endif
+
+  return 0;
+}
+
 /* imap_expunge_mailbox: Purge IMAP portion of expunged messages from the
  *   context. Must not be done while something has a handle on any headers
  *   (eg inside pager or editor). That is, check IMAP_REOPEN_ALLOW. */
@@ -263,7 +316,7 @@ void imap_expunge_mailbox(IMAP_DATA *idata)
   short old_sort;
 
 #ifdef USE_HCACHE
-  idata->hcache = imap_hcache_open(idata, NULL);
+  imap_hcache_acquire(idata);
 #endif
 
   old_sort = Sort;
@@ -323,7 +376,7 @@ void imap_expunge_mailbox(IMAP_DATA *idata)
   }
 
 #if USE_HCACHE
-  imap_hcache_close(idata);
+  imap_hcache_release(idata);
 #endif
 
   /* We may be called on to expunge at any time. We can't rely on the caller
@@ -363,6 +416,9 @@ static int imap_check_capabilities(IMAP_DATA *idata)
  * flags:
  *   MUTT_IMAP_CONN_NONEW    - must be an existing connection
  *   MUTT_IMAP_CONN_NOSELECT - must not be in the IMAP_SELECTED state.
+ *   MUTT_IMAP_CONN_POLL     - used for polling or listing: with
+ *                             $imap_poll_connection, prefer a connection
+ *                             not in the IMAP_SELECTED state.
  */
 IMAP_DATA *imap_conn_find(const ACCOUNT *account, int flags)
 {
@@ -371,6 +427,15 @@ IMAP_DATA *imap_conn_find(const ACCOUNT *account, int flags)
   IMAP_DATA *idata = NULL;
   int new = 0;
 
+  /* Only open the second connection once the account is known to work,
+   * so it won't prompt for credentials, and never with
+   * MUTT_IMAP_CONN_NONEW ($imap_passive). */
+  if ((flags & MUTT_IMAP_CONN_POLL) && option(OPTIMAPPOLLCONN) &&
+      imap_conn_find(account, MUTT_IMAP_CONN_NONEW) &&
+      (idata = imap_conn_find(account, MUTT_IMAP_CONN_NOSELECT |
+                              (flags & MUTT_IMAP_CONN_NONEW))))
+    return idata;
+
   while ((conn = mutt_conn_find(conn, account)))
   {
     if (!creds)
@@ -573,6 +638,7 @@ void imap_close_connection(IMAP_DATA *idata)
   }
   idata->seqno = idata->nextcmd = idata->lastcmd = idata->status = 0;
   memset(idata->cmds, 0, sizeof(IMAP_COMMAND) * idata->cmdslots);
+  FREE(&idata->notify);
 }
 
 /* Try to reconnect and merge current state back in.
@@ -1155,7 +1221,7 @@ int imap_has_flag(LIST *flag_list, const char *flag)
   return 0;
 }
 
-static int compare_uid(const void *a, const void *b)
+int imap_compare_uid(const void *a, const void *b)
 {
   const HEADER * const *pa = (const HEADER * const *) a;
   const HEADER * const *pb = (const HEADER * const *) b;
@@ -1163,22 +1229,80 @@ static int compare_uid(const void *a, const void *b)
   return mutt_numeric_cmp(HEADER_DATA(*pa)->uid, HEADER_DATA(*pb)->uid);
 }
 
+/* imap_set_dirty: called by mutt_set_flag() when a header is marked
+ * changed, so that imap_sync_mailbox() only has to look at these. */
+void imap_set_dirty(CONTEXT *ctx, HEADER *h)
+{
+  IMAP_DATA *idata = (IMAP_DATA *) ctx->data;
+
+  if (!idata || !h->data || HEADER_DATA(h)->dirty)
+    return;
+
+  if (idata->dirty_count == idata->dirty_max)
+  {
+    idata->dirty_max += 256;
+    safe_realloc(&idata->dirty_uids, idata->dirty_max * sizeof(unsigned int));
+  }
+  idata->dirty_uids[idata->dirty_count++] = HEADER_DATA(h)->uid;
+  HEADER_DATA(h)->dirty = 1;
+}
+
+/* imap_dirty_headers: returns the headers in idata->dirty_uids which still
+ * exist, sorted by UID.  The caller must free the array. */
+static HEADER **imap_dirty_headers(IMAP_DATA *idata, int *count)
+{
+  HEADER **hdrs;
+  HEADER *h;
+  unsigned int i;
+
+  *count = 0;
+  if (!idata->dirty_count)
+    return NULL;
+
+  hdrs = safe_malloc(idata->dirty_count * sizeof(HEADER *));
+  for (i = 0; i < idata->dirty_count; i++)
+  {
+    h = (HEADER *) int_hash_find(idata->uid_hash, idata->dirty_uids[i]);
+    if (h && HEADER_DATA(h)->dirty)
+      hdrs[(*count)++] = h;
+  }
+
+  qsort(hdrs, *count, sizeof(HEADER *), imap_compare_uid);
+
+  return hdrs;
+}
+
+/* imap_clear_dirty: forget the dirty list after a successful sync. */
+static void imap_clear_dirty(IMAP_DATA *idata)
+{
+  HEADER *h;
+  unsigned int i;
+
+  for (i = 0; i < idata->dirty_count; i++)
+  {
+    h = (HEADER *) int_hash_find(idata->uid_hash, idata->dirty_uids[i]);
+    if (h)
+      HEADER_DATA(h)->dirty = 0;
+  }
+  idata->dirty_count = 0;
+}
+
 /* Note: headers must be in SORT_UID. See imap_exec_msgset for args.
+ * If sparse is set, hdrs is a subset of the mailbox, so ranges are only
+ * formed from consecutive UIDs.
  * Pos is an opaque pointer a la strtok. It should be 0 at first call. */
-static int imap_make_msg_set(IMAP_DATA *idata, BUFFER *buf, int flag,
-                             int changed, int invert, int *pos)
+static int imap_make_msg_set(BUFFER *buf, HEADER **hdrs, int hdrcount,
+                             int sparse, int flag, int changed, int invert,
+                             int *pos)
 {
-  HEADER **hdrs = idata->ctx->hdrs;
   int count = 0;        /* number of messages in message set */
   int match = 0;        /* whether current message matches flag condition */
   unsigned int setstart = 0;    /* start of current message range */
   int n;
   int started = 0;
 
-  hdrs = idata->ctx->hdrs;
-
   for (n = *pos;
-       (n < idata->ctx->msgcount) && (mutt_buffer_len(buf) < IMAP_MAX_CMDLEN);
+       (n < hdrcount) && (mutt_buffer_len(buf) < IMAP_MAX_CMDLEN);
        n++)
   {
     match = 0;
@@ -1222,6 +1346,15 @@ static int imap_make_msg_set(IMAP_DATA *idata, BUFFER *buf, int flag,
 
     if (match && (!changed || hdrs[n]->changed))
     {
+      /* an unlisted message may sit between two non-consecutive UIDs */
+      if (setstart && sparse &&
+          (HEADER_DATA(hdrs[n])->uid != HEADER_DATA(hdrs[n-1])->uid + 1))
+      {
+        if (HEADER_DATA(hdrs[n-1])->uid > setstart)
+          mutt_buffer_add_printf(buf, ":%u", HEADER_DATA(hdrs[n-1])->uid);
+        setstart = 0;
+      }
+
       count++;
       if (setstart == 0)
       {
@@ -1235,7 +1368,7 @@ static int imap_make_msg_set(IMAP_DATA *idata, BUFFER *buf, int flag,
           mutt_buffer_add_printf(buf, ",%u", HEADER_DATA(hdrs[n])->uid);
       }
       /* tie up if the last message also matches */
-      else if (n == idata->ctx->msgcount-1)
+      else if (n == hdrcount-1)
         mutt_buffer_add_printf(buf, ":%u", HEADER_DATA(hdrs[n])->uid);
     }
     /* End current set if message doesn't match. */
@@ -1252,6 +1385,44 @@ static int imap_make_msg_set(IMAP_DATA *idata, BUFFER *buf, int flag,
   return count;
 }
 
+/* Queues the commands for the matching messages in hdrs, which must be
+ * sorted by UID.  See imap_exec_msgset for the other args. */
+static int imap_exec_msgset_hdrs(IMAP_DATA *idata, const char *pre,
+                                 const char *post, HEADER **hdrs,
+                                 int hdrcount, int sparse, int flag,
+                                 int changed, int invert)
+{
+  BUFFER *cmd;
+  int pos = 0;
+  int rc;
+  int count = 0;
+
+  cmd = mutt_buffer_new();
+
+  do
+  {
+    mutt_buffer_clear(cmd);
+    mutt_buffer_add_printf(cmd, "%s ", pre);
+    rc = imap_make_msg_set(cmd, hdrs, hdrcount, sparse, flag, changed, invert,
+                           &pos);
+    if (rc > 0)
+    {
+      mutt_buffer_add_printf(cmd, " %s", post);
+      if (imap_exec(idata, cmd->data, IMAP_CMD_QUEUE))
+      {
+        count = -1;
+        break;
+      }
+      count += rc;
+    }
+  }
+  while (rc > 0);
+
+  mutt_buffer_free(&cmd);
+
+  return count;
+}
+
 /* Prepares commands for all messages matching conditions (must be flushed
  * with imap_exec)
  * Params:
@@ -1267,12 +1438,8 @@ int imap_exec_msgset(IMAP_DATA *idata, const char *pre, const char *post,
 {
   HEADER **hdrs = NULL;
   short oldsort;
-  BUFFER *cmd;
-  int pos;
   int rc;
-  int count = 0, reopen_set = 0;
-
-  cmd = mutt_buffer_new();
+  int reopen_set = 0;
 
   /* Unlike imap_sync_mailbox(), this function can be called when
    * IMAP_REOPEN_ALLOW is not set.  In that case, the caller isn't
@@ -1298,33 +1465,12 @@ int imap_exec_msgset(IMAP_DATA *idata, const char *pre, const char *post,
 
     Sort = SORT_UID;
     qsort(idata->ctx->hdrs, idata->ctx->msgcount, sizeof(HEADER*),
-          compare_uid);
-  }
-
-  pos = 0;
-
-  do
-  {
-    mutt_buffer_clear(cmd);
-    mutt_buffer_add_printf(cmd, "%s ", pre);
-    rc = imap_make_msg_set(idata, cmd, flag, changed, invert, &pos);
-    if (rc > 0)
-    {
-      mutt_buffer_add_printf(cmd, " %s", post);
-      if (imap_exec(idata, cmd->data, IMAP_CMD_QUEUE))
-      {
-        rc = -1;
-        goto out;
-      }
-      count += rc;
-    }
+          imap_compare_uid);
   }
-  while (rc > 0);
 
-  rc = count;
+  rc = imap_exec_msgset_hdrs(idata, pre, post, idata->ctx->hdrs,
+                             idata->ctx->msgcount, 0, flag, changed, invert);
 
-out:
-  mutt_buffer_free(&cmd);
   if ((oldsort != Sort) || hdrs)
   {
     Sort = oldsort;
@@ -1435,7 +1581,8 @@ int imap_sync_message_for_copy(IMAP_DATA *idata, HEADER *hdr, BUFFER *cmd,
   return 0;
 }
 
-static int sync_helper(IMAP_DATA *idata, int right, int flag, const char *name)
+static int sync_helper(IMAP_DATA *idata, HEADER **hdrs, int hdrcount,
+                       int right, int flag, const char *name)
 {
   int count = 0;
   int rc;
@@ -1451,12 +1598,14 @@ static int sync_helper(IMAP_DATA *idata, int right, int flag, const char *name)
     return 0;
 
   snprintf(buf, sizeof(buf), "+FLAGS.SILENT (%s)", name);
-  if ((rc = imap_exec_msgset(idata, "UID STORE", buf, flag, 1, 0)) < 0)
+  if ((rc = imap_exec_msgset_hdrs(idata, "UID STORE", buf, hdrs, hdrcount, 1,
+                                  flag, 1, 0)) < 0)
     return rc;
   count += rc;
 
   buf[0] = '-';
-  if ((rc = imap_exec_msgset(idata, "UID STORE", buf, flag, 1, 1)) < 0)
+  if ((rc = imap_exec_msgset_hdrs(idata, "UID STORE", buf, hdrs, hdrcount, 1,
+                                  flag, 1, 1)) < 0)
     return rc;
   count += rc;
 
@@ -1473,8 +1622,8 @@ int imap_sync_mailbox(CONTEXT *ctx, int expunge, int *index_hint)
   IMAP_DATA *idata;
   CONTEXT *appendctx = NULL;
   HEADER *h;
-  HEADER **hdrs = NULL;
-  int oldsort;
+  HEADER **dirty;
+  int dirtycount;
   int n;
   int rc, quickdel_rc = 0;
 
@@ -1496,9 +1645,16 @@ int imap_sync_mailbox(CONTEXT *ctx, int expunge, int *index_hint)
   /* if we are expunging anyway, we can do deleted messages very quickly... */
   if (expunge && mutt_bit_isset(ctx->rights, MUTT_ACL_DELETE))
   {
-    if ((quickdel_rc = imap_exec_msgset(idata,
-                                        "UID STORE", "+FLAGS.SILENT (\\Deleted)",
-                                        MUTT_DELETED, 1, 0)) < 0)
+    /* a queue flush must not expunge headers out from under dirty[] */
+    imap_disallow_reopen(ctx);
+    dirty = imap_dirty_headers(idata, &dirtycount);
+    quickdel_rc = imap_exec_msgset_hdrs(idata, "UID STORE",
+                                        "+FLAGS.SILENT (\\Deleted)",
+                                        dirty, dirtycount, 1,
+                                        MUTT_DELETED, 1, 0);
+    FREE(&dirty);
+    imap_allow_reopen(ctx);
+    if (quickdel_rc < 0)
     {
       rc = quickdel_rc;
       mutt_error(_("Expunge failed"));
@@ -1519,7 +1675,7 @@ int imap_sync_mailbox(CONTEXT *ctx, int expunge, int *index_hint)
   }
 
 #if USE_HCACHE
-  idata->hcache = imap_hcache_open(idata, NULL);
+  imap_hcache_acquire(idata);
 #endif
 
   /* save messages with real (non-flag) changes */
@@ -1545,30 +1701,10 @@ int imap_sync_mailbox(CONTEXT *ctx, int expunge, int *index_hint)
        * This works better if we're expunging, of course. */
       if (h->env->changed || h->attach_del)
       {
-        /* NOTE and TODO:
-         *
-         * The mx_open_mailbox() in append mode below merely hijacks an existing
-         * idata; it doesn't reset idata->ctx.  imap_append_message() ends up
-         * using (borrowing) the same idata we are using.
-         *
-         * Right after the APPEND operation finishes, the server can send an
-         * EXISTS notifying of the new message.  Then, while still inside
-         * imap_append_message(), imap_cmd_step() -> imap_cmd_finish() will
-         * call imap_read_headers() to download those (because the idata's
-         * reopen_allow is set).
-         *
-         * The imap_read_headers() will open (and clobber) the idata->hcache we
-         * just opened above, then close it.
-         *
-         * The easy and less dangerous fix done here (for a stable branch bug
-         * fix) is to close and reopen the header cache around the operation.
-         *
-         * A better fix would be allowing idata->hcache reuse.  When that is
-         * done, the close/reopen in read_headers_condstore_qresync_updates()
-         * can also be removed. */
-#if USE_HCACHE
-        imap_hcache_close(idata);
-#endif
+        /* The mx_open_mailbox() in append mode below merely hijacks an
+         * existing idata.  If the server sends an EXISTS right after the
+         * APPEND, imap_read_headers() runs nested inside this loop and
+         * shares the header cache we acquired above. */
         if (!ctx->quiet)
           mutt_message(_("Saving changed messages... [%d/%d]"), n+1,
                        ctx->msgcount);
@@ -1579,63 +1715,46 @@ int imap_sync_mailbox(CONTEXT *ctx, int expunge, int *index_hint)
         else
           _mutt_save_message(h, appendctx, 1, 0, 0);
         h->env->changed = 0;
-#if USE_HCACHE
-        idata->hcache = imap_hcache_open(idata, NULL);
-#endif
       }
     }
   }
 
 #if USE_HCACHE
-  imap_hcache_close(idata);
+  imap_hcache_release(idata);
 #endif
 
-  /* presort here to avoid doing 10 resorts in imap_exec_msgset.
+  /* Only messages marked by mutt_set_flag() can have flag changes to
+   * push, so build the message sets from those, sorted by UID, instead
+   * of resorting and scanning the whole mailbox for each flag.
    *
    * Note: sync_helper() may trigger an imap_exec() if the queue fills
    * up.  Because IMAP_REOPEN_ALLOW is set, this may result in new
-   * messages being downloaded or an expunge being processed.  For new
-   * messages this would both result in memory corruption (since we're
-   * alloc'ing msgcount instead of hdrmax pointers) and data loss of
-   * the new messages.  For an expunge, the restored hdrs would point
-   * to headers that have been freed.
-   *
-   * Since reopen is allowed, we could sort before and after but this
-   * is noticable slower.
+   * messages being downloaded or an expunge being processed.  For an
+   * expunge, dirty[] would point to headers that have been freed.
    *
    * So instead, just turn off reopen_allow for the duration of the
-   * swapped hdrs.  The imap_exec() below flushes the queue out,
+   * sync.  The imap_exec() below flushes the queue out,
    * giving the opportunity to process any reopen events.
    */
   imap_disallow_reopen(ctx);
-  oldsort = Sort;
-  if (Sort != SORT_UID)
-  {
-    hdrs = ctx->hdrs;
-    ctx->hdrs = safe_malloc(ctx->msgcount * sizeof(HEADER*));
-    memcpy(ctx->hdrs, hdrs, ctx->msgcount * sizeof(HEADER*));
-
-    Sort = SORT_UID;
-    qsort(ctx->hdrs, ctx->msgcount, sizeof(HEADER*),
-          compare_uid);
-  }
+  dirty = imap_dirty_headers(idata, &dirtycount);
 
-  rc = sync_helper(idata, MUTT_ACL_DELETE, MUTT_DELETED, "\\Deleted");
+  rc = sync_helper(idata, dirty, dirtycount, MUTT_ACL_DELETE, MUTT_DELETED,
+                   "\\Deleted");
   if (rc >= 0)
-    rc |= sync_helper(idata, MUTT_ACL_WRITE, MUTT_FLAG, "\\Flagged");
+    rc |= sync_helper(idata, dirty, dirtycount, MUTT_ACL_WRITE, MUTT_FLAG,
+                      "\\Flagged");
   if (rc >= 0)
-    rc |= sync_helper(idata, MUTT_ACL_WRITE, MUTT_OLD, "Old");
+    rc |= sync_helper(idata, dirty, dirtycount, MUTT_ACL_WRITE, MUTT_OLD,
+                      "Old");
   if (rc >= 0)
-    rc |= sync_helper(idata, MUTT_ACL_SEEN, MUTT_READ, "\\Seen");
+    rc |= sync_helper(idata, dirty, dirtycount, MUTT_ACL_SEEN, MUTT_READ,
+                      "\\Seen");
   if (rc >= 0)
-    rc |= sync_helper(idata, MUTT_ACL_WRITE, MUTT_REPLIED, "\\Answered");
+    rc |= sync_helper(idata, dirty, dirtycount, MUTT_ACL_WRITE, MUTT_REPLIED,
+                      "\\Answered");
 
-  if ((oldsort != Sort) || hdrs)
-  {
-    Sort = oldsort;
-    FREE(&ctx->hdrs);
-    ctx->hdrs = hdrs;
-  }
+  FREE(&dirty);
   imap_allow_reopen(ctx);
 
   /* Flush the queued flags if any were changed in sync_helper.
@@ -1675,6 +1794,7 @@ int imap_sync_mailbox(CONTEXT *ctx, int expunge, int *index_hint)
     ctx->hdrs[n]->changed = 0;
   }
   ctx->changed = 0;
+  imap_clear_dirty(idata);
 
   /* We must send an EXPUNGE command if we're not closing. */
   if (expunge && !(ctx->closing) &&
@@ -1755,6 +1875,12 @@ int imap_close_mailbox(CONTEXT *ctx)
     FREE(&idata->msn_index);
     idata->msn_index_size = 0;
     idata->max_msn = 0;
+    FREE(&idata->msn_tree);
+    idata->msn_tree_size = 0;
+    idata->msn_tree_len = 0;
+    FREE(&idata->dirty_uids);
+    idata->dirty_count = 0;
+    idata->dirty_max = 0;
 
     for (i = 0; i < IMAP_CACHE_LEN; i++)
     {
@@ -1874,17 +2000,12 @@ static int imap_save_to_header_cache(CONTEXT *ctx, HEADER *h)
 {
   int rc = 0;
 #ifdef USE_HCACHE
-  int close_hc = 1;
   IMAP_DATA *idata;
 
   idata = (IMAP_DATA *)ctx->data;
-  if (idata->hcache)
-    close_hc = 0;
-  else
-    idata->hcache = imap_hcache_open(idata, NULL);
+  imap_hcache_acquire(idata);
   rc = imap_hcache_put(idata, h);
-  if (close_hc)
-    imap_hcache_close(idata);
+  imap_hcache_release(idata);
 #endif
   return rc;
 }
@@ -1899,7 +2020,8 @@ static int imap_get_mailbox(const char *path, IMAP_DATA **hidata, char *buf, siz
     muttdbg(1, "imap_get_mailbox: Error parsing %s", path);
     return -1;
   }
-  if (!(*hidata = imap_conn_find(&(mx.account), option(OPTIMAPPASSIVE) ? MUTT_IMAP_CONN_NONEW : 0)))
+  if (!(*hidata = imap_conn_find(&(mx.account), MUTT_IMAP_CONN_POLL |
+                                 (option(OPTIMAPPASSIVE) ? MUTT_IMAP_CONN_NONEW : 0))))
   {
     FREE(&mx.mbox);
     return -1;
@@ -1913,6 +2035,206 @@ static int imap_get_mailbox(const char *path, IMAP_DATA **hidata, char *buf, siz
   return 0;
 }
 
+/* Registers the polled mailboxes of idata's account with NOTIFY SET
+ * (RFC 5465), so the server reports changes to them.  The command is
+ * only sent again when the list of mailboxes changes. */
+static void imap_notify_set(IMAP_DATA *idata)
+{
+  BUFFY *mailbox;
+  IMAP_MBOX mx;
+  BUFFER *mboxes = NULL, *command = NULL;
+  char name[LONG_STRING];
+  char munged[LONG_STRING];
+  int rc;
+
+  if (!option(OPTIMAPNOTIFY) || !mutt_bit_isset(idata->capabilities, NOTIFY) ||
+      /* the other connection does the polling */
+      (option(OPTIMAPPOLLCONN) && idata->state >= IMAP_SELECTED))
+  {
+    if (idata->notify && imap_exec(idata, "NOTIFY NONE", IMAP_CMD_FAIL_OK) != -1)
+      FREE(&idata->notify);
+    return;
+  }
+
+  mboxes = mutt_buffer_pool_get();
+  command = mutt_buffer_pool_get();
+
+  for (mailbox = Incoming; mailbox; mailbox = mailbox->next)
+  {
+    if (mailbox->magic != MUTT_IMAP || mailbox->nopoll)
+      continue;
+
+    if (imap_parse_path(mutt_b2s(mailbox->pathbuf), &mx) < 0)
+      continue;
+
+    if (imap_account_match(&idata->conn->account, &mx.account))
+    {
+      imap_fix_path(idata, mx.mbox, name, sizeof(name));
+      if (!*name)
+        strfcpy(name, "INBOX", sizeof(name));
+      imap_munge_mbox_name(idata, munged, sizeof(munged), name);
+
+      if (mutt_buffer_len(mboxes))
+        mutt_buffer_addch(mboxes, ' ');
+      mutt_buffer_addstr(mboxes, munged);
+    }
+
+    FREE(&mx.mbox);
+  }
+
+  if (!mutt_strcmp(mutt_b2s(mboxes), idata->notify))
+    goto cleanup;
+
+  /* selected-delayed with all events keeps the usual RFC 3501 behavior
+   * for the selected mailbox.  idata->notify is set beforehand, because
+   * the initial STATUS responses already arrive in NOTIFY format. */
+  if (mutt_buffer_len(mboxes))
+  {
+    mutt_buffer_printf(command,
+                       "NOTIFY SET STATUS"
+                       " (selected-delayed (MessageNew MessageExpunge FlagChange))"
+                       " (mailboxes (%s) (MessageNew MessageExpunge FlagChange))",
+                       mutt_b2s(mboxes));
+    mutt_str_replace(&idata->notify, mutt_b2s(mboxes));
+  }
+  else
+    mutt_buffer_strcpy(command, "NOTIFY NONE");
+
+  rc = imap_exec(idata, mutt_b2s(command), IMAP_CMD_FAIL_OK);
+  if (rc == -2)
+  {
+    muttdbg(1, "NOTIFY failed, disabling");
+    mutt_bit_unset(idata->capabilities, NOTIFY);
+  }
+  if (rc || !mutt_buffer_len(mboxes))
+    FREE(&idata->notify);
+
+cleanup:
+  mutt_buffer_pool_release(&mboxes);
+  mutt_buffer_pool_release(&command);
+}
+
+/* imap_status_sent: note that a STATUS command for mailbox name is about
+ *   to be sent, so that cmd_parse_status() doesn't take the answer for a
+ *   NOTIFY update. */
+static void imap_status_sent(IMAP_DATA *idata, const char *name)
+{
+  IMAP_STATUS *status;
+
+  if ((status = imap_mboxcache_get(idata, name, 1)) &&
+      status->status_sent < UCHAR_MAX)
+    status->status_sent++;
+}
+
+/* imap_status_sent_clear: forget the STATUS commands a server answered
+ *   with NO or BAD, once none are outstanding. */
+static void imap_status_sent_clear(IMAP_DATA *idata)
+{
+  LIST *cur;
+
+  if (imap_cmd_outstanding(idata))
+    return;
+
+  for (cur = idata->mboxcache; cur; cur = cur->next)
+    ((IMAP_STATUS *) cur->data)->status_sent = 0;
+}
+
+/* Updates the NOTIFY registration of every open IMAP connection, and
+ * processes the responses the server has sent on connections without a
+ * selected mailbox, where nobody else reads them: STATUS updates from
+ * NOTIFY, and the results of the previous imap_buffy_check(). */
+static void imap_buffy_update(void)
+{
+  CONNECTION *conn;
+  IMAP_DATA *idata;
+
+  for (conn = mutt_socket_head(); conn; conn = conn->next)
+  {
+    if (conn->account.type != MUTT_ACCT_TYPE_IMAP)
+      continue;
+
+    idata = (IMAP_DATA *) conn->data;
+    if (!idata || idata->state < IMAP_AUTHENTICATED || idata->status == IMAP_FATAL)
+      continue;
+
+    if (idata->state == IMAP_AUTHENTICATED &&
+        (idata->notify || imap_cmd_outstanding(idata)) &&
+        imap_cmd_pump(idata) < 0)
+    {
+      muttdbg(1, "Error reading mailbox status");
+      continue;
+    }
+
+    imap_status_sent_clear(idata);
+    imap_notify_set(idata);
+  }
+}
+
+/* Sends the STATUS commands queued by imap_buffy_check().  Unless forced,
+ * the responses aren't waited for on connections without a selected
+ * mailbox, so a slow server doesn't block the user interface.  They are
+ * collected by imap_buffy_drain() and imap_buffy_update() as they arrive.
+ * Returns 0 on success, -1 on error. */
+static int imap_buffy_flush(IMAP_DATA *idata, int force)
+{
+  if (!force && idata->state == IMAP_AUTHENTICATED)
+    return imap_cmd_start(idata, NULL) < 0 ? -1 : 0;
+
+  return imap_exec(idata, NULL, IMAP_CMD_FAIL_OK | IMAP_CMD_POLL) == -1 ? -1 : 0;
+}
+
+/* Collects the STATUS responses imap_buffy_flush() didn't wait for and
+ * that have already arrived, without blocking.  The rest are read by
+ * imap_buffy_update() at the next check. */
+static void imap_buffy_drain(void)
+{
+  CONNECTION *conn;
+  IMAP_DATA *idata;
+
+  for (conn = mutt_socket_head(); conn; conn = conn->next)
+  {
+    if (conn->account.type != MUTT_ACCT_TYPE_IMAP)
+      continue;
+
+    idata = (IMAP_DATA *) conn->data;
+    if (!idata || idata->state != IMAP_AUTHENTICATED)
+      continue;
+
+    if (imap_cmd_outstanding(idata) && imap_cmd_pump(idata) < 0)
+      muttdbg(1, "Error reading mailbox status");
+  }
+}
+
+/* Returns 1 if mailbox name of idata's account is selected, on this or (with
+ * $imap_poll_connection) another connection. */
+static int imap_mailbox_selected(IMAP_DATA *idata, const char *name)
+{
+  CONNECTION *conn;
+  IMAP_DATA *seldata;
+
+  /* idata->mailbox may be NULL for connections other than the current
+   * mailbox's, and shouldn't expand to INBOX in that case. #3216. */
+  if (idata->mailbox && !imap_mxcmp(name, idata->mailbox))
+    return 1;
+
+  if (!option(OPTIMAPPOLLCONN))
+    return 0;
+
+  for (conn = mutt_socket_head(); conn; conn = conn->next)
+  {
+    if (conn->account.type != MUTT_ACCT_TYPE_IMAP || !conn->data)
+      continue;
+
+    seldata = (IMAP_DATA *) conn->data;
+    if (seldata != idata && seldata->state >= IMAP_SELECTED && seldata->mailbox &&
+        imap_account_match(&idata->conn->account, &conn->account) &&
+        !imap_mxcmp(name, seldata->mailbox))
+      return 1;
+  }
+
+  return 0;
+}
+
 /* check for new mail in any subscribed mailboxes. Given a list of mailboxes
  * rather than called once for each so that it can batch the commands and
  * save on round trips. Returns number of mailboxes with new mail. */
@@ -1921,11 +2243,14 @@ int imap_buffy_check(int force, int check_stats)
   IMAP_DATA *idata;
   IMAP_DATA *lastdata = NULL;
   BUFFY *mailbox;
+  IMAP_STATUS *status;
   char name[LONG_STRING];
   char command[LONG_STRING*2];
   char munged[LONG_STRING];
   int buffies = 0;
 
+  imap_buffy_update();
+
   for (mailbox = Incoming; mailbox; mailbox = mailbox->next)
   {
     /* Init newly-added mailboxes */
@@ -1948,10 +2273,8 @@ int imap_buffy_check(int force, int check_stats)
     }
 
     /* Don't issue STATUS on the selected mailbox, it will be NOOPed or
-     * IDLEd elsewhere.
-     * idata->mailbox may be NULL for connections other than the current
-     * mailbox's, and shouldn't expand to INBOX in that case. #3216. */
-    if (idata->mailbox && !imap_mxcmp(name, idata->mailbox))
+     * IDLEd elsewhere. */
+    if (imap_mailbox_selected(idata, name))
     {
       mailbox->new = 0;
       continue;
@@ -1964,11 +2287,17 @@ int imap_buffy_check(int force, int check_stats)
       continue;
     }
 
+    /* with NOTIFY, the server tells us which mailboxes changed */
+    if (idata->notify && !force && !check_stats &&
+        (status = imap_mboxcache_get(idata, name, 0)) &&
+        !status->notify_changed)
+      continue;
+
     if (lastdata && idata != lastdata)
     {
       /* Send commands to previous server. Sorting the buffy list
        * may prevent some infelicitous interleavings */
-      if (imap_exec(lastdata, NULL, IMAP_CMD_FAIL_OK | IMAP_CMD_POLL) == -1)
+      if (imap_buffy_flush(lastdata, force) < 0)
         muttdbg(1, "Error polling mailboxes");
 
       lastdata = NULL;
@@ -1985,6 +2314,7 @@ int imap_buffy_check(int force, int check_stats)
       snprintf(command, sizeof(command),
                "STATUS %s (UIDNEXT UIDVALIDITY UNSEEN RECENT)", munged);
 
+    imap_status_sent(idata, name);
     if (imap_exec(idata, command, IMAP_CMD_QUEUE | IMAP_CMD_POLL) < 0)
     {
       muttdbg(1, "Error queueing command");
@@ -1992,12 +2322,15 @@ int imap_buffy_check(int force, int check_stats)
     }
   }
 
-  if (lastdata && (imap_exec(lastdata, NULL, IMAP_CMD_FAIL_OK | IMAP_CMD_POLL) == -1))
+  if (lastdata && (imap_buffy_flush(lastdata, force) < 0))
   {
     muttdbg(1, "Error polling mailboxes");
     return 0;
   }
 
+  if (!force)
+    imap_buffy_drain();
+
   /* collect results */
   for (mailbox = Incoming; mailbox; mailbox = mailbox->next)
   {
@@ -2043,12 +2376,16 @@ int imap_status(const char *path, int queue)
 
   if (queue)
   {
+    imap_status_sent(idata, mbox);
     imap_exec(idata, buf, IMAP_CMD_QUEUE);
     queued = 1;
     return 0;
   }
   else if (!queued)
+  {
+    imap_status_sent(idata, mbox);
     imap_exec(idata, buf, 0);
+  }
 
   queued = 0;
   if ((status = imap_mboxcache_get(idata, mbox, 0)))
@@ -2261,12 +2598,70 @@ static int imap_compile_search(const pattern_t *pat, BUFFER *buf)
   return 0;
 }
 
+/* Returns 1 if the pattern looks at header fields which
+ * $imap_lazy_headers may have left out of the envelope. */
+static int search_needs_headers(const pattern_t *pat)
+{
+  for (; pat; pat = pat->next)
+  {
+    switch (pat->op)
+    {
+      case MUTT_AND:
+      case MUTT_OR:
+      case MUTT_THREAD:
+      case MUTT_PARENT:
+      case MUTT_CHILDREN:
+        if (search_needs_headers(pat->child))
+          return 1;
+        break;
+
+      /* flags, sizes, and the fields which are always fetched */
+      case MUTT_ALL:
+      case MUTT_NEW:
+      case MUTT_OLD:
+      case MUTT_REPLIED:
+      case MUTT_READ:
+      case MUTT_UNREAD:
+      case MUTT_DELETED:
+      case MUTT_FLAG:
+      case MUTT_TAG:
+      case MUTT_EXPIRED:
+      case MUTT_SUPERSEDED:
+      case MUTT_TRASH:
+      case MUTT_COLLAPSED:
+      case MUTT_SUBJECT:
+      case MUTT_FROM:
+      case MUTT_DATE:
+      case MUTT_DATE_RECEIVED:
+      case MUTT_DUPLICATED:
+      case MUTT_UNREFERENCED:
+      case MUTT_ID:
+      case MUTT_MESSAGE:
+      case MUTT_SCORE:
+      case MUTT_SIZE:
+      /* these read the message itself, which completes the header */
+      case MUTT_BODY:
+      case MUTT_HEADER:
+      case MUTT_WHOLE_MSG:
+        break;
+
+      default:
+        return 1;
+    }
+  }
+
+  return 0;
+}
+
 int imap_search(CONTEXT *ctx, const pattern_t *pat)
 {
   BUFFER buf;
   IMAP_DATA *idata = (IMAP_DATA*)ctx->data;
   int i;
 
+  if (search_needs_headers(pat) && imap_complete_headers(ctx, NULL, 0) < 0)
+    return -1;
+
   for (i = 0; i < ctx->msgcount; i++)
     ctx->hdrs[i]->matched = 0;
 
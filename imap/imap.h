@@ -40,10 +40,12 @@ int imap_close_mailbox(CONTEXT *ctx);
 int imap_buffy_check(int force, int check_stats);
 int imap_status(const char *path, int queue);
 int imap_search(CONTEXT *ctx, const pattern_t *pat);
+int imap_complete_headers(CONTEXT *ctx, HEADER *cur, int tagged);
 int imap_subscribe(char *path, int subscribe);
 int imap_complete(char *dest, size_t dlen, const char *path);
 int imap_fast_trash(CONTEXT *ctx, char *dest);
 
+void imap_set_dirty(CONTEXT *ctx, HEADER *h);
 void imap_allow_reopen(CONTEXT *ctx);
 void imap_disallow_reopen(CONTEXT *ctx);
 
@@ -57,6 +59,8 @@ int imap_mailbox_rename(const char *mailbox, BUFFER *result);
 /* message.c */
 int imap_append_message(CONTEXT *ctx, MESSAGE *msg);
 int imap_copy_messages(CONTEXT *ctx, HEADER *h, const char *dest, int delete);
+int imap_backfill_pending(CONTEXT *ctx);
+int imap_backfill_headers(CONTEXT *ctx);
 
 /* socket.c */
 void imap_logout_all(void);
@@ -120,6 +120,7 @@ enum
   QRESYNC,                      /* RFC 7162 */
   LIST_EXTENDED,                /* RFC 5258: IMAP4 - LIST Command Extensions */
   COMPRESS_DEFLATE,             /* RFC 4978: COMPRESS=DEFLATE */
+  NOTIFY,                       /* RFC 5465: IMAP NOTIFY Extension */
 
   CAPMAX
 };
@@ -127,6 +128,7 @@ enum
 /* imap_conn_find flags */
 #define MUTT_IMAP_CONN_NONEW    (1<<0)
 #define MUTT_IMAP_CONN_NOSELECT (1<<1)
+#define MUTT_IMAP_CONN_POLL     (1<<2)
 
 /* -- data structures -- */
 typedef struct
@@ -145,6 +147,8 @@ typedef struct
   unsigned int uidvalidity;
   unsigned int unseen;
   unsigned long long modseq;  /* Used by CONDSTORE. 1 <= modseq < 2^63 */
+  unsigned char notify_changed; /* NOTIFY reported a change, STATUS needed */
+  unsigned char status_sent;    /* our STATUS commands not answered yet */
 } IMAP_STATUS;
 
 typedef struct
@@ -198,6 +202,9 @@ typedef struct
 
   int qresync;  /* Set to 1 if QRESYNC is successfully ENABLE'd */
 
+  /* munged mailbox list last registered with NOTIFY SET, NULL if none */
+  char *notify;
+
   /* if set, the response parser will store results for complicated commands
    * here. */
   IMAP_COMMAND_TYPE cmdtype;
@@ -228,12 +235,25 @@ typedef struct
   HEADER **msn_index;          /* look up headers by (MSN-1) */
   unsigned int msn_index_size; /* allocation size */
   unsigned int max_msn;        /* the largest MSN fetched so far */
+  unsigned int backfill_msn;   /* headers at or below this MSN may still be
+                                * missing after a $imap_fetch_newest open */
+  unsigned int *dirty_uids;    /* messages with local flag changes */
+  unsigned int dirty_count;
+  unsigned int dirty_max;
+  /* While a run of EXPUNGEs is being received, msn_index is not shifted.
+   * Instead msn_tree is a Fenwick tree counting the still-live slots of
+   * the first msn_tree_len entries, and imap_msn_index_compact() squeezes
+   * out the holes once the run ends. */
+  unsigned int *msn_tree;
+  unsigned int msn_tree_size;  /* allocation size */
+  unsigned int msn_tree_len;   /* slots covered, or 0 if msn_index is compact */
   body_cache_t *bcache;
 
   /* all folder flags - system flags AND keywords */
   LIST *flags;
 #ifdef USE_HCACHE
   header_cache_t *hcache;
+  int hcache_refs;             /* nested imap_hcache_acquire() calls */
 #endif
 } IMAP_DATA;
 /* I wish that were called IMAP_CONTEXT :( */
@@ -264,12 +284,14 @@ int imap_open_connection(IMAP_DATA *idata);
 void imap_close_connection(IMAP_DATA *idata);
 IMAP_DATA *imap_conn_find(const ACCOUNT *account, int flags);
 int imap_read_literal(FILE *fp, IMAP_DATA *idata, unsigned int bytes, progress_t*);
+int imap_read_literal_buffer(BUFFER *dest, IMAP_DATA *idata, unsigned int bytes);
 void imap_expunge_mailbox(IMAP_DATA *idata);
 void imap_logout(IMAP_DATA **idata);
 int imap_sync_message_for_copy(IMAP_DATA *idata, HEADER *hdr, BUFFER *cmd,
                                int *err_continue);
 int imap_has_flag(LIST *flag_list, const char *flag);
 int imap_reconnect(IMAP_DATA **p_idata);
+int imap_compare_uid(const void *a, const void *b);
 
 /* auth.c */
 int imap_authenticate(IMAP_DATA *idata);
@@ -282,6 +304,9 @@ int imap_code(const char *s);
 const char *imap_cmd_trailer(IMAP_DATA *idata);
 int imap_exec(IMAP_DATA *idata, const char *cmd, int flags);
 int imap_cmd_idle(IMAP_DATA *idata);
+int imap_cmd_outstanding(IMAP_DATA *idata);
+int imap_cmd_pump(IMAP_DATA *idata);
+void imap_msn_index_compact(IMAP_DATA *idata);
 
 /* message.c */
 void imap_add_keywords(char *s, HEADER *keywords, LIST *mailbox_flags, size_t slen);
@@ -300,6 +325,8 @@ int imap_commit_message(CONTEXT *ctx, MESSAGE *msg);
 #ifdef USE_HCACHE
 header_cache_t *imap_hcache_open(IMAP_DATA *idata, const char *path);
 void imap_hcache_close(IMAP_DATA *idata);
+void imap_hcache_acquire(IMAP_DATA *idata);
+void imap_hcache_release(IMAP_DATA *idata);
 HEADER *imap_hcache_get(IMAP_DATA *idata, unsigned int uid);
 int imap_hcache_put(IMAP_DATA *idata, HEADER *h);
 int imap_hcache_del(IMAP_DATA *idata, unsigned int uid);
@@ -70,8 +70,11 @@ static FILE *msg_cache_put(IMAP_DATA *idata, HEADER *h);
 static int msg_cache_commit(IMAP_DATA *idata, HEADER *h);
 
 static int flush_buffer(char *buf, size_t *len, CONNECTION *conn);
+static int msg_header_list(BUFFER *hdr_list, int lazy);
+static char *msg_header_request(IMAP_DATA *idata, int lazy, int *partial);
 static int msg_fetch_header(CONTEXT *ctx, IMAP_HEADER *h, char *buf,
-                            FILE *fp);
+                            BUFFER *hdr);
+static ENVELOPE *msg_parse_header(BUFFER *hdr, HEADER *h);
 static int msg_parse_fetch(IMAP_HEADER *h, char *s);
 static char *msg_parse_flags(IMAP_HEADER *h, char *s);
 
@@ -267,7 +270,7 @@ retry:
   idata->newMailCount = 0;
 
 #if USE_HCACHE
-  idata->hcache = imap_hcache_open(idata, NULL);
+  imap_hcache_acquire(idata);
 
   if (idata->hcache && initial_download)
   {
@@ -348,6 +351,19 @@ retry:
   }
 #endif /* USE_HCACHE */
 
+  /* Only fetch the newest headers now, so the index can be shown right
+   * away.  The rest are filled in by imap_backfill_headers(). */
+  if (initial_download)
+  {
+    idata->backfill_msn = 0;
+    if (ImapFetchNewest > 0 && msn_end >= msn_begin &&
+        msn_end - msn_begin >= (unsigned int) ImapFetchNewest)
+    {
+      idata->backfill_msn = msn_end - ImapFetchNewest;
+      msn_begin = idata->backfill_msn + 1;
+    }
+  }
+
   if (read_headers_fetch_new(idata, msn_begin, msn_end, evalhc, &maxuid,
                              initial_download) < 0)
     goto bail;
@@ -367,6 +383,7 @@ retry:
       uidnext = 0;
       msn_begin = msn_begin_original;
 
+      imap_hcache_release(idata);
       goto retry;
     }
   }
@@ -423,13 +440,98 @@ retry:
 
 bail:
 #if USE_HCACHE
-  imap_hcache_close(idata);
+  imap_hcache_release(idata);
   FREE(&uid_seqset);
 #endif /* USE_HCACHE */
 
   return retval;
 }
 
+/* imap_backfill_pending: returns 1 if ctx is an IMAP mailbox still
+ *   missing headers skipped by a $imap_fetch_newest open. */
+int imap_backfill_pending(CONTEXT *ctx)
+{
+  IMAP_DATA *idata;
+
+  if (!ctx || ctx->magic != MUTT_IMAP || !ctx->data)
+    return 0;
+
+  idata = (IMAP_DATA *) ctx->data;
+  return (idata->state == IMAP_SELECTED && idata->backfill_msn) ? 1 : 0;
+}
+
+/* imap_backfill_headers: fetch the next $imap_fetch_newest missing
+ *   headers, working down from the newest, and renumber the mailbox order
+ *   to match the server's.  Returns the number of headers added, or -1 on
+ *   error.  The caller must resort the index when headers were added. */
+int imap_backfill_headers(CONTEXT *ctx)
+{
+  IMAP_DATA *idata;
+  unsigned int msn_begin, msn_end, msn, maxuid = 0;
+  int oldmsgcount, quiet, idx, rc, reopen_set = 0;
+
+  if (!imap_backfill_pending(ctx))
+    return 0;
+
+  idata = (IMAP_DATA *) ctx->data;
+
+  /* leave pending expunges and new mail to imap_check_mailbox() */
+  if (idata->reopen & (IMAP_EXPUNGE_PENDING|IMAP_NEWMAIL_PENDING))
+    return 0;
+
+  /* expunges only move holes down, so they are all at or below this */
+  msn_end = MIN(idata->backfill_msn, idata->max_msn);
+  if (ImapFetchNewest > 0 && msn_end > (unsigned int) ImapFetchNewest)
+    msn_begin = msn_end - ImapFetchNewest + 1;
+  else
+    msn_begin = 1;
+
+  oldmsgcount = ctx->msgcount;
+  if (idata->reopen & IMAP_REOPEN_ALLOW)
+  {
+    idata->reopen &= ~IMAP_REOPEN_ALLOW;
+    reopen_set = 1;
+  }
+
+  /* no progress bar: this runs between key presses */
+  quiet = ctx->quiet;
+  ctx->quiet = 1;
+
+#if USE_HCACHE
+  imap_hcache_acquire(idata);
+#endif
+
+  rc = read_headers_fetch_new(idata, msn_begin, msn_end, 1, &maxuid, 0);
+  /* don't retry a range the server wouldn't give us */
+  idata->backfill_msn = (rc < 0) ? 0 : msn_begin - 1;
+
+#if USE_HCACHE
+  if (!idata->backfill_msn && idata->qresync)
+    imap_hcache_store_uid_seqset(idata);
+  imap_hcache_release(idata);
+#endif
+
+  ctx->quiet = quiet;
+
+  if (ctx->msgcount > oldmsgcount)
+  {
+    mx_alloc_memory(ctx);
+    mx_update_context(ctx, ctx->msgcount - oldmsgcount);
+
+    /* the new headers were appended, but belong before the ones
+     * already shown in mailbox order */
+    imap_msn_index_compact(idata);
+    for (msn = 0, idx = 0; msn < idata->max_msn; msn++)
+      if (idata->msn_index[msn])
+        idata->msn_index[msn]->index = idx++;
+  }
+
+  if (reopen_set)
+    idata->reopen |= IMAP_REOPEN_ALLOW;
+
+  return (rc < 0) ? -1 : ctx->msgcount - oldmsgcount;
+}
+
 #if USE_HCACHE
 /* Retrieve data from the header cache.
  *
@@ -730,14 +832,12 @@ static int read_headers_condstore_qresync_updates(IMAP_DATA *idata,
   if (idata->reopen & IMAP_EXPUNGE_PENDING)
   {
     short old_sort;
-    imap_hcache_close(idata);
 
     old_sort = Sort;
     Sort = SORT_ORDER;
     imap_expunge_mailbox(idata);
     Sort = old_sort;
 
-    idata->hcache = imap_hcache_open(idata, NULL);
     idata->reopen &= ~IMAP_EXPUNGE_PENDING;
   }
 
@@ -810,7 +910,6 @@ fail:
 
   mutt_hcache_delete(idata->hcache, "/MODSEQ", imap_hcache_keylen);
   imap_hcache_clear_uid_seqset(idata);
-  imap_hcache_close(idata);
 
   if (!ctx->quiet)
   {
@@ -835,64 +934,23 @@ static int read_headers_fetch_new(IMAP_DATA *idata, unsigned int msn_begin,
 {
   CONTEXT *ctx;
   int idx, msgno, rc, mfhrc = 0, retval = -1;
+  int partial;
   unsigned int fetch_msn_end = 0;
   progress_t progress;
   char *hdrreq = NULL, *cmd;
-  BUFFER *tempfile = NULL;
-  FILE *fp = NULL;
   IMAP_HEADER h;
-  BUFFER *b = NULL, *hdr_list = NULL;
-  static const char * const want_headers = "DATE FROM SENDER SUBJECT TO CC MESSAGE-ID REFERENCES CONTENT-TYPE CONTENT-DESCRIPTION IN-REPLY-TO REPLY-TO LINES LIST-POST X-LABEL";
+  BUFFER *b = NULL, *hdr = NULL;
 
   ctx = idata->ctx;
   idx = ctx->msgcount;
 
-  hdr_list = mutt_buffer_pool_get();
-  mutt_buffer_strcpy(hdr_list, want_headers);
-  if (ImapHeaders)
-  {
-    mutt_buffer_addch(hdr_list, ' ');
-    mutt_buffer_addstr(hdr_list, ImapHeaders);
-  }
-#ifdef USE_AUTOCRYPT
-  if (option(OPTAUTOCRYPT))
-  {
-    mutt_buffer_addch(hdr_list, ' ');
-    mutt_buffer_addstr(hdr_list, "AUTOCRYPT");
-  }
-#endif
-
-  if (mutt_bit_isset(idata->capabilities,IMAP4REV1))
-  {
-    safe_asprintf(&hdrreq, "BODY.PEEK[HEADER.FIELDS (%s)]",
-                  mutt_b2s(hdr_list));
-  }
-  else if (mutt_bit_isset(idata->capabilities,IMAP4))
-  {
-    safe_asprintf(&hdrreq, "RFC822.HEADER.LINES (%s)",
-                  mutt_b2s(hdr_list));
-  }
-  else
-  {     /* Unable to fetch headers for lower versions */
-    mutt_error _("Unable to fetch headers from this IMAP server version.");
-    mutt_sleep(2);     /* pause a moment to let the user see the error */
+  if (!(hdrreq = msg_header_request(idata, option(OPTIMAPLAZYHEADERS),
+                                    &partial)))
     goto bail;
-  }
-
-  mutt_buffer_pool_release(&hdr_list);
 
   /* instead of downloading all headers and then parsing them, we parse them
-   * as they come in. */
-  tempfile = mutt_buffer_pool_get();
-  mutt_buffer_mktemp(tempfile);
-  if (!(fp = safe_fopen(mutt_b2s(tempfile), "w+")))
-  {
-    mutt_error(_("Could not create temporary file %s"), mutt_b2s(tempfile));
-    mutt_sleep(2);
-    goto bail;
-  }
-  unlink(mutt_b2s(tempfile));
-  mutt_buffer_pool_release(&tempfile);
+   * as they come in, straight from memory. */
+  hdr = mutt_buffer_pool_get();
 
   if (!ctx->quiet)
     mutt_progress_init(&progress, _("Fetching message headers..."),
@@ -929,7 +987,6 @@ static int read_headers_fetch_new(IMAP_DATA *idata, unsigned int msn_begin,
       if (!ctx->quiet)
         mutt_progress_update(&progress, msgno, -1);
 
-      rewind(fp);
       memset(&h, 0, sizeof(h));
       h.data = safe_calloc(1, sizeof(IMAP_HEADER_DATA));
 
@@ -943,18 +1000,15 @@ static int read_headers_fetch_new(IMAP_DATA *idata, unsigned int msn_begin,
         if (rc != IMAP_CMD_CONTINUE)
           break;
 
-        if ((mfhrc = msg_fetch_header(ctx, &h, idata->buf, fp)) < 0)
+        if ((mfhrc = msg_fetch_header(ctx, &h, idata->buf, hdr)) < 0)
           continue;
 
-        if (!ftello(fp))
+        if (!mutt_buffer_len(hdr))
         {
           muttdbg(2, "ignoring fetch response with no body");
           continue;
         }
 
-        /* make sure we don't get remnants from older larger message headers */
-        fputs("\n\n", fp);
-
         if (h.data->msn < 1 || h.data->msn > fetch_msn_end)
         {
           muttdbg(1, "skipping FETCH response for "
@@ -987,16 +1041,15 @@ static int read_headers_fetch_new(IMAP_DATA *idata, unsigned int msn_begin,
         ctx->hdrs[idx]->flagged = h.data->flagged;
         ctx->hdrs[idx]->replied = h.data->replied;
         ctx->hdrs[idx]->received = h.received;
+        ctx->hdrs[idx]->env_partial = partial;
         ctx->hdrs[idx]->data = (void *) (h.data);
 
         if (*maxuid < h.data->uid)
           *maxuid = h.data->uid;
 
-        rewind(fp);
         /* NOTE: if Date: header is missing, mutt_read_rfc822_header depends
          *   on h.received being set */
-        ctx->hdrs[idx]->env = mutt_read_rfc822_header(fp, ctx->hdrs[idx],
-                                                      0, 0);
+        ctx->hdrs[idx]->env = msg_parse_header(hdr, ctx->hdrs[idx]);
         /* content built as a side-effect of mutt_read_rfc822_header */
         ctx->hdrs[idx]->content->length = h.content_length;
         ctx->size += h.content_length;
@@ -1045,11 +1098,297 @@ static int read_headers_fetch_new(IMAP_DATA *idata, unsigned int msn_begin,
   retval = 0;
 
 bail:
-  mutt_buffer_pool_release(&hdr_list);
   mutt_buffer_pool_release(&b);
-  mutt_buffer_pool_release(&tempfile);
-  safe_fclose(&fp);
+  mutt_buffer_pool_release(&hdr);
+  FREE(&hdrreq);
+
+  return retval;
+}
+
+/* msg_format_uses: returns 1 if the format string uses any of the
+ * given expandos. */
+static int msg_format_uses(const char *fmt, const char *expandos)
+{
+  while (fmt && (fmt = strchr(fmt, '%')))
+  {
+    fmt++;
+    if (*fmt == '?')
+      fmt++;
+    while (*fmt && strchr("-.0123456789=_:", *fmt))
+      fmt++;
+    if (!*fmt)
+      break;
+
+    /* padding: the next character is the fill character */
+    if (strchr(">|*", *fmt))
+    {
+      if (*(++fmt))
+        fmt++;
+      continue;
+    }
+
+    /* skip strftime() formats such as %{%b %d} */
+    if (strchr("{[(<", *fmt))
+    {
+      fmt = strchr(fmt, *fmt == '{' ? '}' : *fmt == '[' ? ']' :
+                   *fmt == '(' ? ')' : '>');
+      continue;
+    }
+
+    if (strchr(expandos, *fmt))
+      return 1;
+    fmt++;
+  }
+
+  return 0;
+}
+
+/* msg_header_list: fills hdr_list with the header fields to request.
+ * With lazy set, this is only what the index needs: enough to sort
+ * and thread, plus the fields used by $index_format and $sort/$sort_aux.
+ * Returns 1 if the list is such a subset, 0 if it is complete. */
+static int msg_header_list(BUFFER *hdr_list, int lazy)
+{
+  static const char * const want_headers = "DATE FROM SENDER SUBJECT TO CC MESSAGE-ID REFERENCES CONTENT-TYPE CONTENT-DESCRIPTION IN-REPLY-TO REPLY-TO LINES LIST-POST X-LABEL";
+  static const char * const lazy_headers = "DATE FROM SUBJECT MESSAGE-ID REFERENCES IN-REPLY-TO";
+  static const struct
+  {
+    const char *expandos;       /* $index_format expandos */
+    int sort;                   /* $sort or $sort_aux method */
+    const char *fields;
+  } LazyFields[] =
+  {
+    { "bBFLOqrRtTZ", SORT_TO,    "TO CC" },
+    { "A",           0,          "REPLY-TO" },
+    { "l",           0,          "LINES" },
+    { "XZ",          0,          "CONTENT-TYPE" },
+    { "yY",          SORT_LABEL, "X-LABEL" },
+    { NULL,          0,          NULL }
+  };
+  int i;
+
+  /* an $index_format_hook pattern may look at any header */
+  if (lazy && msg_format_uses(HdrFmt, "@"))
+    lazy = 0;
+
+  if (!lazy)
+    mutt_buffer_strcpy(hdr_list, want_headers);
+  else
+  {
+    mutt_buffer_strcpy(hdr_list, lazy_headers);
+    for (i = 0; LazyFields[i].expandos; i++)
+    {
+      if (msg_format_uses(HdrFmt, LazyFields[i].expandos) ||
+          (LazyFields[i].sort &&
+           (((Sort & SORT_MASK) == LazyFields[i].sort) ||
+            ((SortAux & SORT_MASK) == LazyFields[i].sort))))
+      {
+        mutt_buffer_addch(hdr_list, ' ');
+        mutt_buffer_addstr(hdr_list, LazyFields[i].fields);
+      }
+    }
+  }
+
+  if (ImapHeaders)
+  {
+    mutt_buffer_addch(hdr_list, ' ');
+    mutt_buffer_addstr(hdr_list, ImapHeaders);
+  }
+#ifdef USE_AUTOCRYPT
+  if (option(OPTAUTOCRYPT))
+  {
+    mutt_buffer_addch(hdr_list, ' ');
+    mutt_buffer_addstr(hdr_list, "AUTOCRYPT");
+  }
+#endif
+
+  return lazy;
+}
+
+/* msg_header_request: returns the FETCH item for the header fields (see
+ * msg_header_list()), or NULL if the server can't fetch header fields.
+ * The caller must free the result. */
+static char *msg_header_request(IMAP_DATA *idata, int lazy, int *partial)
+{
+  BUFFER *hdr_list;
+  char *hdrreq = NULL;
+
+  hdr_list = mutt_buffer_pool_get();
+  *partial = msg_header_list(hdr_list, lazy);
+
+  if (mutt_bit_isset(idata->capabilities,IMAP4REV1))
+  {
+    safe_asprintf(&hdrreq, "BODY.PEEK[HEADER.FIELDS (%s)]",
+                  mutt_b2s(hdr_list));
+  }
+  else if (mutt_bit_isset(idata->capabilities,IMAP4))
+  {
+    safe_asprintf(&hdrreq, "RFC822.HEADER.LINES (%s)",
+                  mutt_b2s(hdr_list));
+  }
+  else
+  {     /* Unable to fetch headers for lower versions */
+    mutt_error _("Unable to fetch headers from this IMAP server version.");
+    mutt_sleep(2);     /* pause a moment to let the user see the error */
+  }
+
+  mutt_buffer_pool_release(&hdr_list);
+  return hdrreq;
+}
+
+/* msg_parse_header: parse a header literal read by msg_fetch_header(). */
+static ENVELOPE *msg_parse_header(BUFFER *hdr, HEADER *h)
+{
+  /* an unterminated last field would be dropped as a partial line */
+  mutt_buffer_addstr(hdr, "\n\n");
+
+  return mutt_read_rfc822_header_buf(hdr->data, mutt_buffer_len(hdr), h, 0, 0);
+}
+
+/* msg_complete_header: merge the complete header just read into hdr into
+ * a header loaded with $imap_lazy_headers. */
+static void msg_complete_header(CONTEXT *ctx, HEADER *h, BUFFER *hdr)
+{
+  ENVELOPE *newenv;
+  LOFF_T length;
+  int had_label = h->env->x_label != NULL;
+
+  length = h->content->length;
+  newenv = msg_parse_header(hdr, h);
+  mutt_merge_envelopes(h->env, &newenv);
+  h->content->length = length;
+
+  if (!had_label)
+    mutt_label_hash_add(ctx, h);
+
+  /* recipients, colors and the index line may depend on the new fields */
+  h->recip_valid = 0;
+  h->color.pair = 0;
+  h->color.attrs = 0;
+  h->env_partial = 0;
+}
+
+/* msg_wants_completion: is h one of the headers imap_complete_headers()
+ * was asked for? */
+static int msg_wants_completion(HEADER *h, HEADER *cur, int tagged)
+{
+  if (!h->env_partial)
+    return 0;
+  if (cur)
+    return h == cur;
+  return !tagged || h->tagged;
+}
+
+/* imap_complete_headers: download the rest of the header fields for
+ * messages loaded with $imap_lazy_headers: for cur if it is set, else
+ * for the tagged messages if tagged is set, else for all of them.
+ * Returns 0 on success, -1 on failure. */
+int imap_complete_headers(CONTEXT *ctx, HEADER *cur, int tagged)
+{
+  IMAP_DATA *idata = (IMAP_DATA *) ctx->data;
+  HEADER **hdrs = NULL;
+  HEADER *h;
+  IMAP_HEADER ih;
+  BUFFER *cmd = NULL, *hdr = NULL;
+  char *hdrreq = NULL;
+  progress_t progress;
+  unsigned int first, last;
+  int count = 0, pos, fetched = 0, partial;
+  int i, rc, mfhrc, retval = -1;
+
+  for (i = 0; i < ctx->msgcount; i++)
+    if (msg_wants_completion(ctx->hdrs[i], cur, tagged))
+      count++;
+  if (!count)
+    return 0;
+
+  if (!(hdrreq = msg_header_request(idata, 0, &partial)))
+    return -1;
+
+  hdrs = safe_malloc(count * sizeof(HEADER *));
+  for (i = 0, pos = 0; i < ctx->msgcount; i++)
+    if (msg_wants_completion(ctx->hdrs[i], cur, tagged))
+      hdrs[pos++] = ctx->hdrs[i];
+  qsort(hdrs, count, sizeof(HEADER *), imap_compare_uid);
+
+  hdr = mutt_buffer_pool_get();
+
+  if (!ctx->quiet)
+    mutt_progress_init(&progress, _("Fetching message headers..."),
+                       MUTT_PROGRESS_MSG, ReadInc, count);
+
+#if USE_HCACHE
+  imap_hcache_acquire(idata);
+#endif
+
+  cmd = mutt_buffer_pool_get();
+  pos = 0;
+  while (pos < count)
+  {
+    mutt_buffer_strcpy(cmd, "UID FETCH ");
+    for (i = 0; (pos < count) && (mutt_buffer_len(cmd) < IMAP_MAX_CMDLEN); i++)
+    {
+      first = last = HEADER_DATA(hdrs[pos])->uid;
+      while ((pos + 1 < count) && (HEADER_DATA(hdrs[pos + 1])->uid == last + 1))
+        last = HEADER_DATA(hdrs[++pos])->uid;
+      pos++;
+
+      if (i)
+        mutt_buffer_addch(cmd, ',');
+      if (first == last)
+        mutt_buffer_add_printf(cmd, "%u", first);
+      else
+        mutt_buffer_add_printf(cmd, "%u:%u", first, last);
+    }
+    mutt_buffer_add_printf(cmd, " (UID %s)", hdrreq);
+
+    if (imap_cmd_start(idata, mutt_b2s(cmd)) < 0)
+      goto bail;
+
+    do
+    {
+      if ((rc = imap_cmd_step(idata)) != IMAP_CMD_CONTINUE)
+        break;
+
+      memset(&ih, 0, sizeof(ih));
+      ih.data = safe_calloc(1, sizeof(IMAP_HEADER_DATA));
+
+      mfhrc = msg_fetch_header(ctx, &ih, idata->buf, hdr);
+      if ((mfhrc == 0) && mutt_buffer_len(hdr))
+      {
+        h = (HEADER *) int_hash_find(idata->uid_hash, ih.data->uid);
+        if (h && h->env_partial)
+        {
+          msg_complete_header(ctx, h, hdr);
+#if USE_HCACHE
+          imap_hcache_put(idata, h);
+#endif
+          if (!ctx->quiet)
+            mutt_progress_update(&progress, ++fetched, -1);
+        }
+      }
+
+      imap_free_header_data(&ih.data);
+      if (mfhrc < -1)
+        rc = IMAP_CMD_BAD;
+    }
+    while (rc == IMAP_CMD_CONTINUE);
+
+    if (rc != IMAP_CMD_OK)
+      goto bail;
+  }
+
+  retval = 0;
+
+bail:
+#if USE_HCACHE
+  if (cmd)
+    imap_hcache_release(idata);
+#endif
+  mutt_buffer_pool_release(&cmd);
+  mutt_buffer_pool_release(&hdr);
   FREE(&hdrreq);
+  FREE(&hdrs);
 
   return retval;
 }
@@ -1070,6 +1409,7 @@ int imap_fetch_message(CONTEXT *ctx, MESSAGE *msg, int msgno, int headers)
   IMAP_CACHE *cache;
   int read;
   int rc;
+  int had_label;
   /* Sam's weird courier server returns an OK response even when FETCH
    * fails. Thanks Sam. */
   short fetched = 0;
@@ -1247,9 +1587,24 @@ parsemsg:
    * picked up in mutt_read_rfc822_header, we mark the message (and context
    * changed). Another possibility: ignore Status on IMAP?*/
   read = h->read;
+  had_label = h->env->x_label != NULL;
   newenv = mutt_read_rfc822_header(msg->fp, h, 0, 0);
   mutt_merge_envelopes(h->env, &newenv);
 
+  /* the header is complete now if it was loaded with $imap_lazy_headers */
+  if (h->env_partial)
+  {
+    h->env_partial = 0;
+    h->recip_valid = 0;
+    if (!had_label)
+      mutt_label_hash_add(ctx, h);
+#if USE_HCACHE
+    imap_hcache_acquire(idata);
+    imap_hcache_put(idata, h);
+    imap_hcache_release(idata);
+#endif
+  }
+
   /* see above. We want the new status in h->read, so we unset it manually
    * and let mutt_set_flag set it correctly, updating context. */
   if (read != h->read)
@@ -1846,7 +2201,7 @@ char *imap_set_flags(IMAP_DATA *idata, HEADER *h, char *s, int *server_changes)
  *      0 on success
  *     -1 if the string is not a fetch response
  *     -2 if the string is a corrupt fetch response */
-static int msg_fetch_header(CONTEXT *ctx, IMAP_HEADER *h, char *buf, FILE *fp)
+static int msg_fetch_header(CONTEXT *ctx, IMAP_HEADER *h, char *buf, BUFFER *hdr)
 {
   IMAP_DATA *idata;
   unsigned int bytes;
@@ -1869,6 +2224,8 @@ static int msg_fetch_header(CONTEXT *ctx, IMAP_HEADER *h, char *buf, FILE *fp)
     return rc;
 
   rc = -2; /* we've got a FETCH response, for better or worse */
+  if (hdr)
+    mutt_buffer_clear(hdr);
   if (!(buf = strchr(buf, '(')))
     return rc;
   buf++;
@@ -1878,12 +2235,13 @@ static int msg_fetch_header(CONTEXT *ctx, IMAP_HEADER *h, char *buf, FILE *fp)
   parse_rc = msg_parse_fetch(h, buf);
   if (!parse_rc)
     return 0;
-  if (parse_rc != -2 || !fp)
+  if (parse_rc != -2 || !hdr)
     return rc;
 
   if (imap_get_literal_count(buf, &bytes) == 0)
   {
-    imap_read_literal(fp, idata, bytes, NULL);
+    if (imap_read_literal_buffer(hdr, idata, bytes) < 0)
+      return rc;
 
     /* we may have other fields of the FETCH _after_ the literal
      * (eg Domino puts FLAGS here). Nothing wrong with that, either.
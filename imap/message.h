@@ -34,6 +34,7 @@ typedef struct imap_header_data
   unsigned int replied : 1;
 
   unsigned int parsed : 1;
+  unsigned int dirty : 1;    /* listed in idata->dirty_uids */
 
   unsigned int uid;     /* 32-bit Message UID */
   unsigned int msn;     /* Message Sequence Number */
@@ -209,6 +209,30 @@ void imap_hcache_close(IMAP_DATA *idata)
   idata->hcache = NULL;
 }
 
+/* imap_hcache_acquire: open idata->hcache for the selected mailbox, or
+ * reuse it if an outer caller already has it open.  Expunges and header
+ * downloads triggered while syncing or fetching run nested inside other
+ * users of the cache, and used to close it out from under them.
+ * Every call must be paired with imap_hcache_release(). */
+void imap_hcache_acquire(IMAP_DATA *idata)
+{
+  if (!idata->hcache_refs++)
+    idata->hcache = imap_hcache_open(idata, NULL);
+}
+
+/* imap_hcache_release: drop a reference taken by imap_hcache_acquire(),
+ * closing the cache (and committing its pending writes) with the last
+ * one.  The cache is not held open between operations, so other mutt
+ * processes can still use it. */
+void imap_hcache_release(IMAP_DATA *idata)
+{
+  if (!idata->hcache_refs)
+    return;
+
+  if (!--idata->hcache_refs)
+    imap_hcache_close(idata);
+}
+
 HEADER *imap_hcache_get(IMAP_DATA *idata, unsigned int uid)
 {
   char key[16];
@@ -528,6 +552,9 @@ void imap_free_idata(IMAP_DATA **idata)
     return;
 
   FREE(&(*idata)->capstr);
+  FREE(&(*idata)->notify);
+  FREE(&(*idata)->msn_tree);
+  FREE(&(*idata)->dirty_uids);
   mutt_free_list(&(*idata)->flags);
   imap_mboxcache_free(*idata);
   mutt_buffer_free(&(*idata)->cmdbuf);
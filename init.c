@@ -407,6 +407,7 @@ static void mutt_free_opt(struct option_t *p)
     case DT_RX:
       pp = (REGEXP*)p->data.p;
       FREE(&pp->pattern);
+      FREE(&pp->literal);
       if (pp->rx)
       {
         regfree(pp->rx);
@@ -1916,6 +1917,7 @@ static void mutt_restore_default(struct option_t *p)
       int flags = 0;
 
       FREE(&pp->pattern);
+      FREE(&pp->literal);
       if (pp->rx)
       {
         regfree(pp->rx);
@@ -1942,6 +1944,8 @@ static void mutt_restore_default(struct option_t *p)
           FREE(&pp->pattern);
           FREE(&pp->rx);
         }
+        else
+          mutt_set_regexp_literal(pp, s, flags);
       }
     }
     break;
@@ -2573,6 +2577,7 @@ static int parse_set(BUFFER *tmp, BUFFER *s, union pointer_long_t udata, BUFFER
         ptr->pattern = safe_strdup(tmp->data);
         ptr->rx = rx;
         ptr->not = not;
+        mutt_set_regexp_literal(ptr, p, flags);
 
         /* $reply_regexp and $alterantes require special treatment */
 
@@ -2590,7 +2595,7 @@ static int parse_set(BUFFER *tmp, BUFFER *s, union pointer_long_t udata, BUFFER
             if (cur_env && cur_env->subject)
             {
               cur_env->real_subj =
-                (regexec(ReplyRegexp.rx, cur_env->subject, 1, pmatch, 0)) ?
+                (mutt_regexec(&ReplyRegexp, cur_env->subject, 1, pmatch, 0)) ?
                 cur_env->subject :
                 cur_env->subject + pmatch[0].rm_eo;
             }
@@ -3064,6 +3069,11 @@ int mutt_parse_rc_buffer(BUFFER *line, BUFFER *token, BUFFER *err)
 
   mutt_buffer_clear(err);
 
+  /* almost any command can change what an index line looks like,
+   * or how the pager colors a message */
+  mutt_invalidate_index_lines();
+  mutt_clear_pager_cache();
+
   /* Read from the beginning of line->data */
   mutt_buffer_rewind(line);
 
@@ -1709,6 +1709,20 @@ struct option_t MuttVars[] = {
   ** of this many headers, instead of a single FETCH for all new
   ** headers.
   */
+  { "imap_fetch_newest",        DT_NUM,  R_NONE, {.p=&ImapFetchNewest}, {.l=0} },
+  /*
+  ** .pp
+  ** When set to a value greater than 0, opening an IMAP mailbox whose
+  ** headers are not in the header cache only downloads the newest this
+  ** many headers before showing the index.  The older headers are
+  ** fetched afterwards, this many at a time, whenever the index is
+  ** waiting for a key press, and the index is updated as they arrive.
+  ** Setting it to about the height of your screen makes large
+  ** mailboxes usable almost immediately.
+  ** .pp
+  ** Until the download completes, searches and limits only see the
+  ** headers fetched so far.
+  */
   { "imap_headers",     DT_STR, R_INDEX, {.p=&ImapHeaders}, {.p=0} },
   /*
   ** .pp
@@ -1743,6 +1757,22 @@ struct option_t MuttVars[] = {
   ** violated every now and then. Reduce this number if you find yourself
   ** getting disconnected from your IMAP server due to inactivity.
   */
+  { "imap_lazy_headers",        DT_BOOL, R_NONE, {.l=OPTIMAPLAZYHEADERS}, {.l=0} },
+  /*
+  ** .pp
+  ** When \fIset\fP, mutt only downloads the header fields needed to
+  ** sort, thread and display the index when it opens an IMAP mailbox.
+  ** These are ``Date:'', ``From:'', ``Subject:'', ``Message-Id:'',
+  ** ``References:'' and ``In-Reply-To:'', plus whatever
+  ** $$index_format, $$sort and $$sort_aux use, and $$imap_headers.
+  ** This makes the first screen of a large mailbox appear much sooner.
+  ** .pp
+  ** The remaining headers are fetched when a message is viewed, or all
+  ** at once the first time a pattern needs them (e.g. for
+  ** \fC<limit>\fP or \fC<search>\fP).  \fBNote:\fP score, spam and
+  ** ``color index'' rules are only matched against the fields that have
+  ** been fetched, so add the headers they use to $$imap_headers.
+  */
   { "imap_list_subscribed",     DT_BOOL, R_NONE, {.l=OPTIMAPLSUB}, {.l=0} },
   /*
   ** .pp
@@ -1757,6 +1787,17 @@ struct option_t MuttVars[] = {
   ** .pp
   ** This variable defaults to the value of $$imap_user.
   */
+  { "imap_notify",      DT_BOOL, R_NONE, {.l=OPTIMAPNOTIFY}, {.l=0} },
+  /*
+  ** .pp
+  ** When \fIset\fP, mutt will use the IMAP NOTIFY extension (RFC 5465),
+  ** if advertised by the server, to have it report changes to the
+  ** mailboxes given with the ``$mailboxes'' command.  Mutt then only
+  ** issues STATUS commands for mailboxes the server reported as changed,
+  ** instead of for every mailbox each $$mail_check seconds.  Message
+  ** counts are still refreshed every $$mail_check_stats_interval seconds
+  ** if $$mail_check_stats is set.
+  */
   { "imap_oauth_refresh_command", DT_STR, R_NONE, {.p=&ImapOauthRefreshCmd}, {.p=0} },
   /*
   ** .pp
@@ -1785,6 +1826,20 @@ struct option_t MuttVars[] = {
   ** user/password pairs on mutt invocation, or if opening the connection
   ** is slow.
   */
+  { "imap_poll_connection", DT_BOOL, R_NONE, {.l=OPTIMAPPOLLCONN}, {.l=0} },
+  /*
+  ** .pp
+  ** When \fIset\fP, mutt checks IMAP mailboxes for new mail and lists
+  ** folders in the browser over a connection which doesn't have a mailbox
+  ** selected.  Once a connection to an account has been established, a
+  ** second one is opened for this if needed, so at most two connections
+  ** per account are used.  With $$imap_passive set, polling only uses
+  ** such a connection if it is already open.  This leaves the connection of the open mailbox
+  ** (and its IDLE state, see $$imap_idle) alone while polling.
+  ** .pp
+  ** Some servers limit the number of concurrent connections per user, so
+  ** this is \fIunset\fP by default.
+  */
   { "imap_peek", DT_BOOL, R_NONE, {.l=OPTIMAPPEEK}, {.l=1} },
   /*
   ** .pp
@@ -2027,6 +2082,21 @@ struct option_t MuttVars[] = {
   ** This variable configures how often (in seconds) mutt should look for
   ** new mail. Also see the $$timeout variable.
   */
+#ifdef USE_INOTIFY
+  { "mail_check_monitor", DT_BOOL, R_NONE, {.l=OPTMAILCHECKMONITOR}, {.l=0} },
+  /*
+  ** .pp
+  ** When \fIset\fP, local mailboxes which are being monitored for changes
+  ** (see ``$new-mail-monitoring'') are only checked for new mail when
+  ** the monitor reports a change, and are checked immediately in that case.
+  ** Mailboxes which can't be monitored, and mailboxes which have new mail,
+  ** are still polled every $$mail_check seconds.  Message counts for $$mail_check_stats are still refreshed
+  ** every $$mail_check_stats_interval seconds.
+  ** .pp
+  ** Don't set this if your mailboxes live on a network file system such
+  ** as NFS: changes made by other machines are not reported there.
+  */
+#endif
   { "mail_check_recent",DT_BOOL, R_NONE, {.l=OPTMAILCHECKRECENT}, {.l=1} },
   /*
   ** .pp
@@ -2461,6 +2531,19 @@ struct option_t MuttVars[] = {
   ** is less than $$pager_index_lines, then the index will only use as
   ** many lines as it needs.
   */
+  { "pager_read_ahead", DT_NUM,  R_NONE, {.p=&PagerReadAhead}, {.l=0} },
+  /*
+  ** .pp
+  ** When set to a value greater than 0, the internal pager lays out the
+  ** rest of the message this many lines at a time whenever it is waiting
+  ** for a key press, instead of only when a line is first shown.  Jumping
+  ** to the bottom of, or searching through, a very large message is then
+  ** immediate once the layout has caught up.  An active search is run
+  ** ahead over the same lines.
+  ** .pp
+  ** A value of a few thousand is reasonable.  A value of 0 disables this
+  ** feature.
+  */
   { "pager_skip_quoted_context", DT_NUM, R_NONE, {.p=&PagerSkipQuotedContext}, {.l=0} },
   /*
   ** .pp
@@ -442,7 +442,26 @@ int km_dokey(int menu)
   FOREVER
   {
     i = Timeout > 0 ? Timeout : 60;
+
+    /* don't wait for a key while the pager has a message left to lay out */
+    if (menu == MENU_PAGER && !pos && mutt_pager_layout_pending())
+    {
+      mutt_getch_timeout(0);
+      tmp = mutt_getch();
+      mutt_getch_timeout(-1);
+      goto gotkey;
+    }
+
 #ifdef USE_IMAP
+    /* don't wait for a key while the index has headers left to fetch */
+    if (menu == MENU_MAIN && !pos && imap_backfill_pending(Context))
+    {
+      mutt_getch_timeout(0);
+      tmp = mutt_getch();
+      mutt_getch_timeout(-1);
+      goto gotkey;
+    }
+
     /* keepalive may need to run more frequently than Timeout allows */
     if (ImapKeepalive)
     {
@@ -474,9 +493,7 @@ int km_dokey(int menu)
     tmp = mutt_getch();
     mutt_getch_timeout(-1);
 
-#ifdef USE_IMAP
   gotkey:
-#endif
     /* hide timeouts, but not window resizes, from the line editor. */
     if (menu == MENU_EDITOR && tmp.ch == -2 && !SigWinch)
       continue;
@@ -1337,7 +1337,7 @@ int main(int argc, char **argv, char **environ)
       if (passive)
         unset_option(OPTIMAPPASSIVE);
 #endif
-      if (!mutt_buffy_check(0))
+      if (!mutt_buffy_check(MUTT_BUFFY_CHECK_FORCE))
       {
         exit_endwin_msg = _("No mailbox with new mail.");
         goto cleanup_and_exit;
@@ -1426,6 +1426,7 @@ cleanup_and_exit:
 #endif
   mutt_browser_cleanup();
   mutt_commands_cleanup();
+  mutt_iconv_cache_flush();
   crypt_cleanup();
   mutt_signal_cleanup();
   mutt_free_opts();
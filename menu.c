@@ -221,6 +221,46 @@ static void menu_pad_string(MUTTMENU *menu, char *s, size_t n)
   FREE(&scratch);
 }
 
+/* Forget what is on the screen, e.g. after it has been cleared. */
+void menu_invalidate_rows(MUTTMENU *menu)
+{
+  int i;
+
+  for (i = 0; i < menu->rowslen; i++)
+  {
+    FREE(&menu->rows[i].text);
+    menu->rows[i].blank = 0;
+  }
+}
+
+static void menu_forget_row(MUTTMENU *menu, int i)
+{
+  int row = i - menu->top;
+
+  if (row >= 0 && row < menu->rowslen)
+  {
+    FREE(&menu->rows[row].text);
+    menu->rows[row].blank = 0;
+  }
+}
+
+static void menu_check_rows(MUTTMENU *menu)
+{
+  int i;
+
+  if (menu->rowslen == menu->pagelen && menu->rowsoffset == menu->offset &&
+      !memcmp(&menu->rowswin, menu->indexwin, sizeof(mutt_window_t)))
+    return;
+
+  menu_invalidate_rows(menu);
+  safe_realloc(&menu->rows, menu->pagelen * sizeof(MENU_ROW));
+  for (i = menu->rowslen; i < menu->pagelen; i++)
+    memset(&menu->rows[i], 0, sizeof(MENU_ROW));
+  menu->rowslen = menu->pagelen;
+  menu->rowsoffset = menu->offset;
+  memcpy(&menu->rowswin, menu->indexwin, sizeof(mutt_window_t));
+}
+
 void menu_redraw_full(MUTTMENU *menu)
 {
 #if ! (defined(USE_SLANG_CURSES) || defined(HAVE_RESIZETERM))
@@ -230,6 +270,7 @@ void menu_redraw_full(MUTTMENU *menu)
   /* clear() doesn't optimize screen redraws */
   move(0, 0);
   clrtobot();
+  menu_invalidate_rows(menu);
 
   if (option(OPTHELP))
   {
@@ -274,15 +315,31 @@ void menu_redraw_index(MUTTMENU *menu)
   char buf[LONG_STRING];
   int i;
   COLOR_ATTR attr;
+  MENU_ROW *row;
+
+  menu_check_rows(menu);
 
   for (i = menu->top; i < menu->top + menu->pagelen; i++)
   {
+    row = &menu->rows[i - menu->top];
+
     if (i < menu->max)
     {
       attr = menu->color(i);
 
       menu_make_entry(buf, sizeof(buf), menu, i);
       menu_pad_string(menu, buf, sizeof(buf));
+
+      /* leave rows alone which would be drawn exactly as they are */
+      if (row->text && row->current == (i == menu->current) &&
+          row->color.pair == attr.pair && row->color.attrs == attr.attrs &&
+          !mutt_strcmp(row->text, buf))
+        continue;
+      mutt_str_replace(&row->text, buf);
+      row->color = attr;
+      row->current = (i == menu->current);
+      row->blank = 0;
+
       mutt_window_move(menu->indexwin, i - menu->top + menu->offset, 0);
 
       if (i == menu->current)
@@ -308,8 +365,11 @@ void menu_redraw_index(MUTTMENU *menu)
         print_enriched_string(attr, (unsigned char *) buf, 0);
       }
     }
-    else
+    else if (!row->blank)
     {
+      FREE(&row->text);
+      row->blank = 1;
+
       NORMAL_COLOR;
       mutt_window_clearline(menu->indexwin, i - menu->top + menu->offset);
     }
@@ -335,6 +395,8 @@ void menu_redraw_motion(MUTTMENU *menu)
    * position the cursor for drawing. */
   old_color = menu->color(menu->oldcurrent);
   mutt_window_move(menu->indexwin, menu->oldcurrent + menu->offset - menu->top, 0);
+  menu_forget_row(menu, menu->oldcurrent);
+  menu_forget_row(menu, menu->current);
 
   if (option(OPTARROWCURSOR))
   {
@@ -377,6 +439,7 @@ void menu_redraw_current(MUTTMENU *menu)
   char buf[LONG_STRING];
   COLOR_ATTR attr = menu->color(menu->current);
 
+  menu_forget_row(menu, menu->current);
   mutt_window_move(menu->indexwin, menu->current + menu->offset - menu->top, 0);
   menu_make_entry(buf, sizeof(buf), menu, menu->current);
   menu_pad_string(menu, buf, sizeof(buf));
@@ -754,6 +817,9 @@ void mutt_menuDestroy(MUTTMENU **p)
 {
   int i;
 
+  menu_invalidate_rows(*p);
+  FREE(&(*p)->rows);
+
   if ((*p)->dialog)
   {
     for (i=0; i < (*p)->max; i++)
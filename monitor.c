@@ -189,6 +189,25 @@ static void monitor_delete(MONITOR *monitor)
   *ptr = monitor;
 }
 
+/* monitor_buffy_changed: flag the mailboxes watched by descriptor descr as changed.
+ * If new_descr differs from descr, the mailboxes are moved to it. -1 means they
+ * are not watched anymore and fall back to polling.
+ */
+static void monitor_buffy_changed(int descr, int new_descr)
+{
+  BUFFY *b;
+
+  for (b = Incoming; b; b = b->next)
+  {
+    if (b->monitor_descr == descr)
+    {
+      b->monitor_descr = new_descr;
+      b->monitor_changed = 1;
+      MonitorBuffyChanged = 1;
+    }
+  }
+}
+
 static int monitor_handle_ignore(int descr)
 {
   int new_descr = -1;
@@ -219,6 +238,7 @@ static int monitor_handle_ignore(int descr)
 
     if (MonitorContextDescriptor == descr)
       MonitorContextDescriptor = new_descr;
+    monitor_buffy_changed(descr, new_descr);
 
     if (new_descr == -1)
     {
@@ -301,8 +321,12 @@ int mutt_monitor_poll(void)
                         event->wd, event->mask);
                 if (event->mask & IN_IGNORED)
                   monitor_handle_ignore(event->wd);
-                else if (event->wd == MonitorContextDescriptor)
-                  MonitorContextChanged = 1;
+                else
+                {
+                  if (event->wd == MonitorContextDescriptor)
+                    MonitorContextChanged = 1;
+                  monitor_buffy_changed(event->wd, event->wd);
+                }
                 ptr += sizeof(struct inotify_event) + event->len;
               }
             }
@@ -404,11 +428,22 @@ int mutt_monitor_add(BUFFY *buffy)
 
   monitor_info_init(&info);
 
+  if (buffy)
+    buffy->monitor_descr = -1;
+
   descr = monitor_resolve(&info, buffy);
   if (descr != RESOLVERES_OK_NOTEXISTING)
   {
-    if (!buffy && (descr == RESOLVERES_OK_EXISTING))
-      MonitorContextDescriptor = info.monitor->descr;
+    if (descr == RESOLVERES_OK_EXISTING)
+    {
+      if (!buffy)
+        MonitorContextDescriptor = info.monitor->descr;
+      else
+      {
+        buffy->monitor_descr = info.monitor->descr;
+        buffy->monitor_changed = 1;
+      }
+    }
     rc = descr == RESOLVERES_OK_EXISTING ? 0 : -1;
     goto cleanup;
   }
@@ -425,6 +460,12 @@ int mutt_monitor_add(BUFFY *buffy)
   muttdbg(3, "monitor: inotify_add_watch descriptor=%d for '%s'", descr, info.path);
   if (!buffy)
     MonitorContextDescriptor = descr;
+  else
+  {
+    /* nothing is known about changes before the watch existed */
+    buffy->monitor_descr = descr;
+    buffy->monitor_changed = 1;
+  }
 
   monitor_create(&info, descr);
 
@@ -453,6 +494,8 @@ int mutt_monitor_remove(BUFFY *buffy)
     MonitorContextDescriptor = -1;
     MonitorContextChanged = 0;
   }
+  else
+    buffy->monitor_descr = -1;
 
   if (monitor_resolve(&info, buffy) != RESOLVERES_OK_EXISTING)
   {
@@ -21,6 +21,7 @@
 
 WHERE int MonitorFilesChanged;
 WHERE int MonitorContextChanged;
+WHERE int MonitorBuffyChanged;
 
 #ifdef _BUFFY_H
 int mutt_monitor_add(BUFFY *b);
@@ -143,7 +143,8 @@ typedef enum
   MUTT_FORMAT_STAT_FILE   = (1<<3), /* used by mutt_attach_fmt */
   MUTT_FORMAT_ARROWCURSOR = (1<<4), /* reserve space for arrow_cursor */
   MUTT_FORMAT_INDEX       = (1<<5), /* this is a main index entry */
-  MUTT_FORMAT_NOFILTER    = (1<<6)  /* do not allow filtering on this pass */
+  MUTT_FORMAT_NOFILTER    = (1<<6), /* do not allow filtering on this pass */
+  MUTT_FORMAT_NOCACHE     = (1<<7)  /* template is transient, don't compile it */
 } format_flag;
 
 /* mode for mutt_write_rfc822_header() */
@@ -451,9 +452,12 @@ enum
   OPTIMAPCHECKSUBSCRIBED,
   OPTIMAPCONDSTORE,
   OPTIMAPIDLE,
+  OPTIMAPLAZYHEADERS,
   OPTIMAPLSUB,
+  OPTIMAPNOTIFY,
   OPTIMAPPASSIVE,
   OPTIMAPPEEK,
+  OPTIMAPPOLLCONN,
   OPTIMAPQRESYNC,
   OPTIMAPSERVERNOISE,
 #ifdef USE_ZLIB
@@ -484,6 +488,9 @@ enum
   OPTLOCALDATEHEADER,
   OPTMUTTLISPINLINEEVAL,
   OPTMAILCAPSANITIZE,
+#ifdef USE_INOTIFY
+  OPTMAILCHECKMONITOR,
+#endif
   OPTMAILCHECKRECENT,
   OPTMAILCHECKSTATS,
   OPTMAILDIRTRASH,
@@ -893,6 +900,8 @@ typedef struct header
                                          * This flag is used by the maildir_trash
                                          * option.
                                          */
+  unsigned int env_partial : 1;         /* only some header fields have been
+                                         * read ($imap_lazy_headers) */
 
   /* timezone of the sender of this message */
   unsigned int zhours : 5;
@@ -931,6 +940,13 @@ typedef struct header
   char *tree;                   /* character string to print thread tree */
   THREAD *thread;
 
+  /* cached index_make_entry() output and the state it was made in */
+  char *index_line;
+  unsigned int index_line_gen;
+  int index_line_cols;
+  format_flag index_line_flags;
+  time_t index_line_time;
+
   /* Number of qualifying attachments in message, if attach_valid */
   short attach_total;
 
@@ -961,6 +977,7 @@ struct mutt_thread
   unsigned int deep : 1;
   unsigned int subtree_visible : 2;
   unsigned int next_subtree_visible : 1;
+  unsigned int unread : 2;      /* MUTT_THREAD_UNREAD result, see unread_gen */
   THREAD *parent;
   THREAD *child;
   THREAD *next;
@@ -968,6 +985,8 @@ struct mutt_thread
   HEADER *message;
   HEADER *sort_group_key;  /* $sort_thread_groups - for thread roots */
   HEADER *sort_aux_key;    /* $sort_aux - for messages below the root */
+  unsigned int tree_gen;   /* when the tree below this root was drawn */
+  unsigned int unread_gen; /* mutt_index_lines_gen() when unread was set */
 };
 
 
@@ -1000,7 +1019,7 @@ typedef struct pattern_t
   unsigned int alladdr : 1;
   unsigned int stringmatch : 1;
   unsigned int groupmatch : 1;
-  unsigned int ign_case : 1;            /* ignore case for local stringmatch searches */
+  unsigned int ign_case : 1;            /* ignore case for stringmatch and literal */
   unsigned int isalias : 1;
   unsigned int dynamic : 1;  /* evaluate date ranges at run time */
   unsigned int sendmode : 1; /* evaluate searches in send-mode */
@@ -1008,6 +1027,7 @@ typedef struct pattern_t
   int max;
   struct pattern_t *next;
   struct pattern_t *child;              /* arguments to logical op */
+  char *literal;                        /* required substring of p.rx */
   union
   {
     regex_t *rx;
@@ -1175,6 +1195,7 @@ void state_mark_attach(STATE *);
 void state_mark_protected_header(STATE *);
 void state_attach_puts(const char *, STATE *);
 void state_prefix_putc(char, STATE *);
+void state_prefix_put(const char *, size_t, STATE *);
 int  state_printf(STATE *, const char *, ...);
 int state_putwc(wchar_t, STATE *);
 int state_putws(const wchar_t *, STATE *);
@@ -152,11 +152,18 @@ typedef struct color_line
   regoff_t cached_rm_so;
   regoff_t cached_rm_eo;
 
+  char *literal;        /* substring every match of rx contains, or NULL */
+  size_t literal_len;
+  struct color_line *literal_next; /* same first letter, for the prefilter */
+  unsigned long regexec_calls;     /* cost of this pattern in the pager */
+  unsigned long prefilter_skips;
+
   unsigned int stop_matching : 1; /* used by the pager for body patterns,
                                      to prevent the color from being retried
                                      once it fails. */
   unsigned int cached : 1; /* indicates cached_rm_so and cached_rm_eo
                             * hold the last match location */
+  unsigned int literal_icase : 1;
 } COLOR_LINE;
 
 #define MUTT_PROGRESS_SIZE      (1<<0)  /* traffic-based progress */
@@ -227,6 +234,8 @@ extern COLOR_LINE *ColorHdrList;
 extern COLOR_LINE *ColorBodyList;
 extern COLOR_LINE *ColorIndexList;
 
+void mutt_color_prefilter(COLOR_LINE *, const char *);
+
 void ci_start_color(void);
 
 /* Prefer bkgrndset because it allows more color pairs to be used.
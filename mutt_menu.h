@@ -41,6 +41,15 @@
 
 #define MUTT_MODEFMT "-- Mutt: %s"
 
+/* what menu_redraw_index() last put on a row of the screen */
+typedef struct menu_row
+{
+  char *text;           /* padded entry, NULL if unknown or blank */
+  COLOR_ATTR color;
+  unsigned int current : 1;     /* drawn with the indicator */
+  unsigned int blank : 1;       /* cleared, past the last entry */
+} MENU_ROW;
+
 typedef struct menu_t
 {
   char *title;   /* the title of this menu */
@@ -94,6 +103,13 @@ typedef struct menu_t
   int oldcurrent;       /* for driver use only. */
   int searchDir;        /* direction of search */
   int tagged;           /* number of tagged entries */
+
+  /* rows as last drawn, so menu_redraw_index() can skip unchanged ones.
+   * Only valid for the window geometry and offset they were drawn with. */
+  MENU_ROW *rows;
+  int rowslen;
+  int rowsoffset;
+  mutt_window_t rowswin;
 } MUTTMENU;
 
 void mutt_menu_init(void);
@@ -106,6 +122,7 @@ void menu_redraw_index(MUTTMENU *);
 void menu_redraw_status(MUTTMENU *);
 void menu_redraw_motion(MUTTMENU *);
 void menu_redraw_current(MUTTMENU *);
+void menu_invalidate_rows(MUTTMENU *);
 int  menu_redraw(MUTTMENU *);
 void menu_first_entry(MUTTMENU *);
 void menu_last_entry(MUTTMENU *);
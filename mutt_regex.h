@@ -44,6 +44,8 @@ typedef struct
   char *pattern;        /* printable version */
   regex_t *rx;          /* compiled expression */
   int not;              /* do not match */
+  char *literal;        /* required substring, see mutt_regex_literal() */
+  int icase;            /* literal is matched ignoring case */
 } REGEXP;
 
 WHERE REGEXP AbortNoattachRegexp;
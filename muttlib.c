@@ -389,6 +389,7 @@ void mutt_free_header(HEADER **h)
   mutt_free_body(&(*h)->content);
   FREE(&(*h)->maildir_flags);
   FREE(&(*h)->tree);
+  FREE(&(*h)->index_line);
   FREE(&(*h)->path);
 #ifdef MIXMASTER
   mutt_free_list(&(*h)->chain);
@@ -730,7 +731,7 @@ char *mutt_gecos_name(char *dest, size_t destlen, struct passwd *pw)
 
   if (GecosMask.rx)
   {
-    if (regexec(GecosMask.rx, pw->pw_gecos, 1, pat_match, 0) == 0)
+    if (mutt_regexec(&GecosMask, pw->pw_gecos, 1, pat_match, 0) == 0)
       strfcpy(dest, pw->pw_gecos + pat_match[0].rm_so,
               MIN(pat_match[0].rm_eo - pat_match[0].rm_so + 1, destlen));
   }
@@ -1481,7 +1482,7 @@ char *mutt_apply_replace(char *d, size_t dlen, char *s, REPLACE_LIST *rlist)
       nmatch = l->nmatch;
     }
 
-    if (regexec(l->rx->rx, mutt_b2s(srcbuf), l->nmatch, pmatch, 0) == 0)
+    if (mutt_regexec(l->rx, mutt_b2s(srcbuf), l->nmatch, pmatch, 0) == 0)
     {
       muttdbg(5, "%s matches %s",
               mutt_b2s(srcbuf), l->rx->pattern);
@@ -1535,6 +1536,294 @@ char *mutt_apply_replace(char *d, size_t dlen, char *s, REPLACE_LIST *rlist)
 }
 
 
+/* Compiled format templates.
+ *
+ * mutt_FormatString() runs for every index line, sidebar entry, browser
+ * entry and status line, and re-parsing the template each time was a
+ * large part of its cost.  The first time a template is seen it is split
+ * into segments: runs of printable ASCII text with %% and backslash
+ * escapes already resolved, and %-expandos with their prefix, conditional
+ * strings and modifiers.  Later calls copy the text runs in one go and
+ * hand the expandos straight to the callback.
+ *
+ * Anything that isn't compiled (padding, multibyte or control characters,
+ * malformed sequences) is left to the interpreter in mutt_FormatString(),
+ * which switches back to the compiled form whenever it reaches the start
+ * of a segment.  Templates are keyed on their contents, so changing a
+ * format variable simply misses the cache.
+ */
+#define FORMAT_CACHE_SIZE 16
+
+typedef struct format_seg
+{
+  size_t off;                   /* where the segment starts in the template */
+  char *text;                   /* literal output, NULL for an expando */
+  size_t len;                   /* length (and width) of text */
+  size_t next;                  /* offset just past the text */
+
+  /* expandos only */
+  size_t args;                  /* offset handed to the callback */
+  char op;
+  unsigned int optional : 1;
+  unsigned int tolower : 1;
+  unsigned int nodots : 1;
+  char *prefix;
+  char *ifstring;
+  char *elsestring;
+} FORMAT_SEG;
+
+typedef struct format_template
+{
+  char *src;
+  size_t srclen;
+  unsigned int hash;
+  FORMAT_SEG *segs;
+  int nsegs;
+  int busy;                     /* in use by a (recursive) caller */
+  unsigned long used;
+} FORMAT_TEMPLATE;
+
+static FORMAT_TEMPLATE FormatCache[FORMAT_CACHE_SIZE];
+static unsigned long FormatCacheClock = 0;
+
+static void format_free_template(FORMAT_TEMPLATE *t)
+{
+  int i;
+
+  for (i = 0; i < t->nsegs; i++)
+  {
+    FREE(&t->segs[i].text);
+    FREE(&t->segs[i].prefix);
+    FREE(&t->segs[i].ifstring);
+    FREE(&t->segs[i].elsestring);
+  }
+  FREE(&t->segs);
+  FREE(&t->src);
+  t->nsegs = 0;
+}
+
+static FORMAT_SEG *format_add_seg(FORMAT_TEMPLATE *t, int *max, size_t off)
+{
+  FORMAT_SEG *seg;
+
+  if (t->nsegs == *max)
+  {
+    *max += 8;
+    safe_realloc(&t->segs, *max * sizeof(FORMAT_SEG));
+  }
+  seg = &t->segs[t->nsegs++];
+  memset(seg, 0, sizeof(FORMAT_SEG));
+  seg->off = off;
+  return seg;
+}
+
+/* Split a template the same way mutt_FormatString() parses it.  This
+ * stops at the first construct the interpreter has to deal with on its
+ * own, because only the interpreter knows where that construct ends. */
+static void format_compile(FORMAT_TEMPLATE *t)
+{
+  const char *s = t->src, *p, *q;
+  FORMAT_SEG *seg;
+  BUFFER *text;
+  int max = 0;
+
+  text = mutt_buffer_pool_get();
+
+  while (*s)
+  {
+    /* a run of text: printable ASCII, escapes and %% */
+    mutt_buffer_clear(text);
+    for (p = s; *p; )
+    {
+      if (*p == '%' && p[1] == '%')
+      {
+        mutt_buffer_addch(text, '%');
+        p += 2;
+      }
+      else if (*p == '\\' && p[1])
+      {
+        switch (p[1])
+        {
+          case 'n': mutt_buffer_addch(text, '\n'); break;
+          case 't': mutt_buffer_addch(text, '\t'); break;
+          case 'r': mutt_buffer_addch(text, '\r'); break;
+          case 'f': mutt_buffer_addch(text, '\f'); break;
+          case 'v': mutt_buffer_addch(text, '\v'); break;
+          default:  mutt_buffer_addch(text, p[1]); break;
+        }
+        p += 2;
+      }
+      else if (*p != '%' && *p != '\\' && (unsigned char) *p >= 0x20 && (unsigned char) *p < 0x7f)
+        mutt_buffer_addch(text, *p++);
+      else
+        break;
+    }
+    if (p > s)
+    {
+      seg = format_add_seg(t, &max, s - t->src);
+      seg->len = mutt_buffer_len(text);
+      seg->text = safe_strdup(mutt_b2s(text));
+      seg->next = p - t->src;
+      s = p;
+      continue;
+    }
+
+    if (*s != '%')
+    {
+      /* let the interpreter decode other characters */
+      if (*s == '\\')
+        break;
+      s++;
+      continue;
+    }
+
+    /* an expando */
+    seg = format_add_seg(t, &max, s - t->src);
+    p = s + 1;
+    if (*p == '?')
+    {
+      seg->optional = 1;
+      p++;
+    }
+    else
+    {
+      for (q = p; isdigit((unsigned char) *q) || *q == '.' || *q == '-' || *q == '='; q++)
+        ;
+      if (q - p >= SHORT_STRING)
+        break;
+      seg->prefix = mutt_substrdup(p, q);
+      p = q;
+    }
+
+    if (!*p)
+      break;
+    seg->op = *p++;
+
+    if (seg->optional)
+    {
+      if (*p != '?')
+        break;
+      p++;
+
+      for (q = p; *q && *q != '?' && *q != '&'; q++)
+        ;
+      if (q - p >= SHORT_STRING)
+        break;
+      seg->ifstring = mutt_substrdup(p, q);
+      p = q;
+
+      if (*p == '&')
+        p++;
+      for (q = p; *q && *q != '?'; q++)
+        ;
+      if (q - p >= SHORT_STRING)
+        break;
+      seg->elsestring = mutt_substrdup(p, q);
+      p = q;
+
+      if (!*p)
+        break;
+      p++;
+    }
+
+    if (seg->op == '>' || seg->op == '*' || seg->op == '|')
+      break;
+
+    while (seg->op == '_' || seg->op == ':')
+    {
+      if (seg->op == '_')
+        seg->tolower = 1;
+      else
+        seg->nodots = 1;
+      seg->op = *p++;
+    }
+    if (!seg->op)
+      break;
+
+    seg->args = p - t->src;
+    s = p;
+
+    /* the callback may consume more of the template, e.g. %{...}, so the
+     * next segment can't be known here.  Keep going: whatever follows is
+     * used only if the callback stops right in front of it. */
+  }
+
+  /* drop an expando we couldn't finish */
+  if (t->nsegs && !t->segs[t->nsegs - 1].text && !t->segs[t->nsegs - 1].args)
+  {
+    t->nsegs--;
+    FREE(&t->segs[t->nsegs].prefix);
+    FREE(&t->segs[t->nsegs].ifstring);
+    FREE(&t->segs[t->nsegs].elsestring);
+  }
+
+  mutt_buffer_pool_release(&text);
+}
+
+/* Returns the compiled form of src, or NULL if every slot is busy. */
+static FORMAT_TEMPLATE *format_get_template(const char *src)
+{
+  FORMAT_TEMPLATE *t, *victim = NULL;
+  unsigned int hash = 0;
+  const char *p;
+  size_t len;
+  int i;
+
+  for (p = src; *p; p++)
+    hash = hash * 31 + (unsigned char) *p;
+  if (!(len = p - src))
+    return NULL;
+
+  for (i = 0; i < FORMAT_CACHE_SIZE; i++)
+  {
+    t = &FormatCache[i];
+    if (t->src && t->hash == hash && t->srclen == len && !memcmp(t->src, src, len))
+    {
+      t->used = ++FormatCacheClock;
+      return t;
+    }
+    if (!t->busy && (!victim || t->used < victim->used))
+      victim = t;
+  }
+
+  if (!victim)
+    return NULL;
+
+  format_free_template(victim);
+  victim->src = safe_strdup(src);
+  victim->srclen = len;
+  victim->hash = hash;
+  victim->used = ++FormatCacheClock;
+  format_compile(victim);
+  return victim;
+}
+
+/* Append a callback's expansion to the output, as for any expando. */
+static void format_append(char *buf, short tolower, short nodots,
+                          char **wptr, size_t *wlen, size_t *col,
+                          size_t destlen, int cols)
+{
+  size_t len;
+
+  if (tolower)
+    mutt_strlower(buf);
+  if (nodots)
+  {
+    char *p = buf;
+    for (; *p; p++)
+      if (*p == '.')
+        *p = '_';
+  }
+
+  if ((len = mutt_strlen(buf)) + *wlen > destlen)
+    len = mutt_wstr_trunc(buf, destlen - *wlen, cols - *col, NULL);
+
+  memcpy(*wptr, buf, len);
+  *wptr += len;
+  *wlen += len;
+  *col += mutt_strwidth(buf);
+}
+
 void mutt_FormatString(char *dest,             /* output buffer */
                        size_t destlen,         /* output buffer len */
                        size_t col,             /* starting column (nonzero when called recursively) */
@@ -1551,6 +1840,10 @@ void mutt_FormatString(char *dest,             /* output buffer */
   FILE *filter;
   int n;
   char *recycler;
+  const char *base = src;
+  FORMAT_TEMPLATE *tmpl = NULL;
+  FORMAT_SEG *seg;
+  int segno = 0;
 
   prefix[0] = '\0';
   destlen--; /* save room for the terminal \0 */
@@ -1662,7 +1955,8 @@ void mutt_FormatString(char *dest,             /* output buffer */
                  * it back for the recursive call since the expansion of
                  * format pipes does not try to append a nul itself.
                  */
-                mutt_FormatString(dest, destlen+1, col, cols, recycler, callback, data, flags);
+                mutt_FormatString(dest, destlen+1, col, cols, recycler, callback, data,
+                                  flags | MUTT_FORMAT_NOCACHE);
                 FREE(&recycler);
               }
             }
@@ -1688,8 +1982,52 @@ void mutt_FormatString(char *dest,             /* output buffer */
     }
   }
 
+  if (!(flags & MUTT_FORMAT_NOCACHE) && (tmpl = format_get_template(src)))
+    tmpl->busy++;
+
   while (*src && wlen < destlen)
   {
+    /* use the compiled template whenever we are at one of its segments */
+    seg = NULL;
+    if (tmpl)
+    {
+      while (segno < tmpl->nsegs && tmpl->segs[segno].off < (size_t)(src - base))
+        segno++;
+      if (segno < tmpl->nsegs && tmpl->segs[segno].off == (size_t)(src - base))
+        seg = &tmpl->segs[segno];
+    }
+
+    if (seg && seg->text && wlen + seg->len < destlen)
+    {
+      memcpy(wptr, seg->text, seg->len);
+      wptr += seg->len;
+      wlen += seg->len;
+      col += seg->len;
+      src = base + seg->next;
+      continue;
+    }
+    else if (seg && !seg->text)
+    {
+      if (seg->optional)
+      {
+        flags |= MUTT_FORMAT_OPTIONAL;
+        strfcpy(ifstring, seg->ifstring, sizeof(ifstring));
+        strfcpy(elsestring, seg->elsestring, sizeof(elsestring));
+      }
+      else
+      {
+        flags &= ~MUTT_FORMAT_OPTIONAL;
+        strfcpy(prefix, seg->prefix, sizeof(prefix));
+      }
+
+      *buf = '\0';
+      src = callback(buf, sizeof(buf), col, cols, seg->op, base + seg->args,
+                     prefix, ifstring, elsestring, data, flags);
+      format_append(buf, seg->tolower, seg->nodots, &wptr, &wlen, &col,
+                    destlen, cols);
+      continue;
+    }
+
     if (*src == '%')
     {
       if (*++src == '%')
@@ -1881,24 +2219,7 @@ void mutt_FormatString(char *dest,             /* output buffer */
         /* use callback function to handle this case */
         *buf = '\0';
         src = callback(buf, sizeof(buf), col, cols, ch, src, prefix, ifstring, elsestring, data, flags);
-
-        if (tolower)
-          mutt_strlower(buf);
-        if (nodots)
-        {
-          char *p = buf;
-          for (; *p; p++)
-            if (*p == '.')
-              *p = '_';
-        }
-
-        if ((len = mutt_strlen(buf)) + wlen > destlen)
-          len = mutt_wstr_trunc(buf, destlen - wlen, cols - col, NULL);
-
-        memcpy(wptr, buf, len);
-        wptr += len;
-        wlen += len;
-        col += mutt_strwidth(buf);
+        format_append(buf, tolower, nodots, &wptr, &wlen, &col, destlen, cols);
       }
     }
     else if (*src == '\\')
@@ -1953,6 +2274,9 @@ void mutt_FormatString(char *dest,             /* output buffer */
     }
   }
   *wptr = 0;
+
+  if (tmpl)
+    tmpl->busy--;
 }
 
 /* This function allows the user to specify a command to read stdout from in
@@ -2079,6 +2403,41 @@ void state_prefix_putc(char c, STATE *s)
     state_set_prefix(s);
 }
 
+/* state_prefix_put: like calling state_prefix_putc() for each of the
+ * dlen bytes at d, but hands whole lines to stdio. */
+void state_prefix_put(const char *d, size_t dlen, STATE *s)
+{
+  const char *nl;
+  size_t n;
+
+  if (!s->prefix)
+  {
+    fwrite(d, dlen, 1, s->fpout);
+    return;
+  }
+
+  while (dlen)
+  {
+    if (s->flags & MUTT_PENDINGPREFIX)
+    {
+      state_reset_prefix(s);
+      state_puts(s->prefix, s);
+    }
+
+    if ((nl = memchr(d, '\n', dlen)))
+    {
+      n = nl - d + 1;
+      state_set_prefix(s);
+    }
+    else
+      n = dlen;
+
+    fwrite(d, n, 1, s->fpout);
+    d += n;
+    dlen -= n;
+  }
+}
+
 int state_printf(STATE *s, const char *fmt, ...)
 {
   int rv;
@@ -2107,12 +2466,18 @@ void state_mark_protected_header(STATE *s)
 
 void state_attach_puts(const char *t, STATE *s)
 {
+  size_t n;
+
   if (*t != '\n') state_mark_attach(s);
   while (*t)
   {
-    state_putc(*t, s);
-    if (*t++ == '\n' && *t)
-      if (*t != '\n') state_mark_attach(s);
+    n = strcspn(t, "\n");
+    if (t[n] == '\n')
+      n++;
+    fwrite(t, n, 1, s->fpout);
+    t += n;
+    if (t[-1] == '\n' && *t && *t != '\n')
+      state_mark_attach(s);
   }
 }
 
@@ -2131,14 +2496,31 @@ int state_putwc(wchar_t wc, STATE *s)
 int state_putws(const wchar_t *ws, STATE *s)
 {
   const wchar_t *p = ws;
+  char buf[STRING];
+  size_t l = 0, rc;
+  int rv = 0;
 
+  /* convert into buf and write it out a block at a time */
   while (p && *p != L'\0')
   {
-    if (state_putwc(*p, s) < 0)
-      return -1;
+    if (l + MB_LEN_MAX > sizeof(buf))
+    {
+      if (fwrite(buf, 1, l, s->fpout) != l)
+        return -1;
+      l = 0;
+    }
+    if ((rc = wcrtomb(buf + l, *p, NULL)) == (size_t)(-1))
+    {
+      rv = -1;
+      break;
+    }
+    l += rc;
     p++;
   }
-  return 0;
+
+  if (l && fwrite(buf, 1, l, s->fpout) != l)
+    return -1;
+  return rv;
 }
 
 void mutt_sleep(short s)
@@ -2280,6 +2662,8 @@ REGEXP *mutt_compile_regexp(const char *s, int flags)
   pp->rx = safe_calloc(sizeof(regex_t), 1);
   if (REGCOMP(pp->rx, NONULL(s), flags) != 0)
     mutt_free_regexp(&pp);
+  else
+    mutt_set_regexp_literal(pp, NONULL(s), flags);
 
   return pp;
 }
@@ -2287,11 +2671,51 @@ REGEXP *mutt_compile_regexp(const char *s, int flags)
 void mutt_free_regexp(REGEXP **pp)
 {
   FREE(&(*pp)->pattern);
+  FREE(&(*pp)->literal);
   regfree((*pp)->rx);
   FREE(&(*pp)->rx);
   FREE(pp);            /* __FREE_CHECKED__ */
 }
 
+static unsigned long RegexecCalls = 0, RegexecSkips = 0;
+
+/* Records the required literal of rx, whose expression s was compiled
+ * with flags, so that mutt_regexec() can rule out most strings without
+ * running the regex engine. */
+void mutt_set_regexp_literal(REGEXP *rx, const char *s, int flags)
+{
+  FREE(&rx->literal);
+  rx->literal = mutt_regex_literal(s);
+  rx->icase = (flags & REG_ICASE) ? 1 : 0;
+}
+
+/* Returns 1 if s doesn't contain literal, so that the regex it was
+ * extracted from can't match s either. */
+int mutt_regexec_skip(const char *literal, int icase, const char *s)
+{
+  if (literal && !(icase ? strcasestr(s, literal) : strstr(s, literal)))
+  {
+    RegexecSkips++;
+    return 1;
+  }
+  RegexecCalls++;
+  return 0;
+}
+
+int mutt_regexec(const REGEXP *rx, const char *s, size_t nmatch,
+                 regmatch_t pmatch[], int eflags)
+{
+  if (mutt_regexec_skip(rx->literal, rx->icase, s))
+    return REG_NOMATCH;
+  return regexec(rx->rx, s, nmatch, pmatch, eflags);
+}
+
+void mutt_log_regexec_stats(void)
+{
+  muttdbg(2, "regex prefilter: %lu regexec calls, %lu skipped by literal",
+          RegexecCalls, RegexecSkips);
+}
+
 void mutt_free_rx_list(RX_LIST **list)
 {
   RX_LIST *p;
@@ -2327,7 +2751,7 @@ int mutt_match_rx_list(const char *s, RX_LIST *l)
 
   for (; l; l = l->next)
   {
-    if (regexec(l->rx->rx, s, (size_t) 0, (regmatch_t *) 0, (int) 0) == 0)
+    if (mutt_regexec(l->rx, s, (size_t) 0, (regmatch_t *) 0, (int) 0) == 0)
     {
       muttdbg(5, "%s matches %s", s, l->rx->pattern);
       return 1;
@@ -2363,7 +2787,7 @@ int mutt_match_spam_list(const char *s, REPLACE_LIST *l, char *text, int textsiz
     }
 
     /* Does this pattern match? */
-    if (regexec(l->rx->rx, s, (size_t) l->nmatch, (regmatch_t *) pmatch, (int) 0) == 0)
+    if (mutt_regexec(l->rx, s, (size_t) l->nmatch, (regmatch_t *) pmatch, (int) 0) == 0)
     {
       muttdbg(5, "%s matches %s", s, l->rx->pattern);
       muttdbg(5, "%d subs", (int)l->rx->rx->re_nsub);
@@ -118,6 +118,7 @@ struct line_t
   short type;
   short chunks;
   short search_cnt;
+  unsigned int sum;             /* checksum of the source line */
   unsigned int continuation : 1;
   unsigned int is_cont_hdr  : 1; /* continuation of header line */
   unsigned int show_patterns_done : 1; /* body patterns and quote type computed,
@@ -127,6 +128,45 @@ struct line_t
   struct q_class_t *quote;
 };
 
+/* The classification of a source line, as left behind by resolve_types()
+ * and resolve_show_patterns().  Offsets in syntax are relative to the
+ * start of the line, so they survive rewrapping. */
+struct line_class_t
+{
+  LOFF_T offset;
+  unsigned int sum;             /* checksum of the line it was worked out for */
+  short type;
+  short chunks;
+  unsigned int is_cont_hdr  : 1;
+  unsigned int show_patterns_done : 1;
+  struct syntax_t *syntax;      /* MAX (chunks, 1) entries */
+  struct q_class_t *quote;
+};
+
+/* Everything worked out about the lines of one pager file.  It is reused
+ * when the text is reflowed, and kept for a while after the pager exits
+ * so that showing the same message or attachment again (re-entering it,
+ * toggling the header weeding back) doesn't rerun the header, quote and
+ * body color regexps.  Each line is checked against its checksum as it
+ * is restored, in case the text came out different this time. */
+struct pager_classes_t
+{
+  HEADER *hdr;
+  BODY *bdy;
+  LOFF_T size;
+  int flags;
+  unsigned int gen;             /* PagerClassGen the entries are valid for */
+  struct line_class_t *lines;
+  int count;
+  struct q_class_t *QuoteList;
+  int q_level;
+};
+
+#define PAGER_CLASS_CACHE 4
+
+static struct pager_classes_t *PagerClasses[PAGER_CLASS_CACHE];
+static unsigned int PagerClassGen = 0;
+
 #define ANSI_OFF       (1<<0)
 #define ANSI_BLINK     (1<<1)
 #define ANSI_BOLD      (1<<2)
@@ -418,6 +458,192 @@ cleanup_quote(struct q_class_t **QuoteList)
   return;
 }
 
+/* The configuration has changed: colors, $quote_regex, $smileys and so on
+ * are all inputs to the line classification. */
+void mutt_clear_pager_cache(void)
+{
+  PagerClassGen++;
+}
+
+static void
+free_line_classes(struct pager_classes_t *classes)
+{
+  int i;
+
+  for (i = 0; i < classes->count; i++)
+    FREE(&classes->lines[i].syntax);
+  classes->count = 0;
+}
+
+static void
+free_pager_classes(struct pager_classes_t **classes)
+{
+  if (!*classes)
+    return;
+  free_line_classes(*classes);
+  FREE(&(*classes)->lines);
+  cleanup_quote(&(*classes)->QuoteList);
+  FREE(classes);       /* __FREE_CHECKED__ */
+}
+
+static unsigned int line_sum(const unsigned char *s)
+{
+  unsigned int sum = 0;
+
+  while (*s)
+    sum = sum * 31 + *s++;
+  return sum;
+}
+
+/* Returns the classification kept for the file of size bytes showing
+ * hdr/bdy, or a new empty one. */
+static struct pager_classes_t *
+get_pager_classes(HEADER *hdr, BODY *bdy, LOFF_T size, int flags)
+{
+  struct pager_classes_t *classes;
+  int i;
+
+  for (i = 0; i < PAGER_CLASS_CACHE && PagerClasses[i]; i++)
+  {
+    classes = PagerClasses[i];
+    if (classes->hdr == hdr && classes->bdy == bdy &&
+        classes->size == size && classes->flags == flags &&
+        classes->gen == PagerClassGen)
+    {
+      for (; i + 1 < PAGER_CLASS_CACHE; i++)
+        PagerClasses[i] = PagerClasses[i + 1];
+      PagerClasses[i] = NULL;
+      return classes;
+    }
+  }
+
+  classes = safe_calloc(1, sizeof(struct pager_classes_t));
+  classes->hdr = hdr;
+  classes->bdy = bdy;
+  classes->size = size;
+  classes->flags = flags;
+  classes->gen = PagerClassGen;
+  return classes;
+}
+
+/* Keep classes for the next time the same text is shown. */
+static void
+put_pager_classes(struct pager_classes_t *classes)
+{
+  int i;
+
+  if (classes->gen != PagerClassGen || !classes->count)
+  {
+    free_pager_classes(&classes);
+    return;
+  }
+
+  free_pager_classes(&PagerClasses[PAGER_CLASS_CACHE - 1]);
+  for (i = PAGER_CLASS_CACHE - 1; i > 0; i--)
+    PagerClasses[i] = PagerClasses[i - 1];
+  PagerClasses[0] = classes;
+}
+
+/* Record what is known about the lines in lineInfo.  Entries for lines
+ * further down, from an earlier pass, are kept. */
+static void
+save_line_classes(struct pager_classes_t *classes, struct line_t *lineInfo,
+                  int last)
+{
+  struct line_class_t *lines, *lc;
+  int i, j, count = 0, chunks;
+
+  if (classes->gen != PagerClassGen)
+  {
+    /* classified under an older configuration */
+    free_line_classes(classes);
+    return;
+  }
+
+  for (i = 0; i < last; i++)
+    if (!lineInfo[i].continuation && lineInfo[i].type != -1)
+      count++;
+  if (!count)
+    return;
+
+  /* skip the old entries which are about to be replaced */
+  for (j = 0; j < classes->count; j++)
+    if (classes->lines[j].offset > lineInfo[last - 1].offset)
+      break;
+
+  lines = safe_malloc((count + classes->count - j) * sizeof(struct line_class_t));
+  for (i = 0, lc = lines; i < last; i++)
+  {
+    if (lineInfo[i].continuation || lineInfo[i].type == -1)
+      continue;
+    chunks = MAX(lineInfo[i].chunks, 1);
+    lc->offset = lineInfo[i].offset;
+    lc->sum = lineInfo[i].sum;
+    lc->type = lineInfo[i].type;
+    lc->chunks = lineInfo[i].chunks;
+    lc->is_cont_hdr = lineInfo[i].is_cont_hdr;
+    lc->show_patterns_done = lineInfo[i].show_patterns_done;
+    lc->quote = lineInfo[i].quote;
+    lc->syntax = safe_malloc(chunks * sizeof(struct syntax_t));
+    memcpy(lc->syntax, lineInfo[i].syntax, chunks * sizeof(struct syntax_t));
+    lc++;
+  }
+  memcpy(lc, classes->lines + j, (classes->count - j) * sizeof(struct line_class_t));
+
+  for (i = 0; i < j; i++)
+    FREE(&classes->lines[i].syntax);
+  FREE(&classes->lines);
+  classes->lines = lines;
+  classes->count = count + classes->count - j;
+}
+
+/* Fill in lineInfo[n], whose text is buf, from an earlier pass.  Lines
+ * are restored top down, so once one doesn't match the rest can't be
+ * trusted either.  Returns 1 on success, 0 if there is nothing to restore
+ * and -1 if the text has changed. */
+static int
+restore_line_class(struct pager_classes_t *classes, struct line_t *lineInfo,
+                   int n, const unsigned char *buf)
+{
+  struct line_class_t *lc;
+  int lo, hi, mid, chunks;
+
+  if (!classes || classes->gen != PagerClassGen)
+    return 0;
+
+  lo = 0;
+  hi = classes->count - 1;
+  while (lo <= hi)
+  {
+    mid = (lo + hi) / 2;
+    lc = &classes->lines[mid];
+    if (lc->offset < lineInfo[n].offset)
+      lo = mid + 1;
+    else if (lc->offset > lineInfo[n].offset)
+      hi = mid - 1;
+    else
+    {
+      if (lc->sum != line_sum(buf))
+      {
+        free_line_classes(classes);
+        return -1;
+      }
+
+      chunks = MAX(lc->chunks, 1);
+      lineInfo[n].sum = lc->sum;
+      lineInfo[n].type = lc->type;
+      lineInfo[n].chunks = lc->chunks;
+      lineInfo[n].is_cont_hdr = lc->is_cont_hdr;
+      lineInfo[n].show_patterns_done = lc->show_patterns_done;
+      lineInfo[n].quote = lc->quote;
+      safe_realloc(&lineInfo[n].syntax, chunks * sizeof(struct syntax_t));
+      memcpy(lineInfo[n].syntax, lc->syntax, chunks * sizeof(struct syntax_t));
+      return 1;
+    }
+  }
+  return 0;
+}
+
 static struct q_class_t *
 classify_quote(struct q_class_t **QuoteList, const char *qptr,
                int length, int *force_redraw, int *q_level)
@@ -750,17 +976,17 @@ mutt_is_quote_line(char *buf, regmatch_t *pmatch)
     pmatch = pmatch_internal;
 
   if (QuoteRegexp.rx &&
-      regexec((regex_t *) QuoteRegexp.rx, buf, 1, pmatch, 0) == 0)
+      mutt_regexec(&QuoteRegexp, buf, 1, pmatch, 0) == 0)
   {
     if (Smileys.rx &&
-        regexec((regex_t *) Smileys.rx, buf, 1, smatch, 0) == 0)
+        mutt_regexec(&Smileys, buf, 1, smatch, 0) == 0)
     {
       if (smatch[0].rm_so > 0)
       {
         c = buf[smatch[0].rm_so];
         buf[smatch[0].rm_so] = 0;
 
-        if (regexec((regex_t *) QuoteRegexp.rx, buf, 1, pmatch, 0) == 0)
+        if (mutt_regexec(&QuoteRegexp, buf, 1, pmatch, 0) == 0)
           is_quote = 1;
 
         buf[smatch[0].rm_so] = c;
@@ -801,11 +1027,7 @@ match_body_patterns(char *buf, struct line_t *lineInfo, int n)
   else
     color_list = ColorBodyList;
 
-  for (color_line = color_list; color_line; color_line = color_line->next)
-  {
-    color_line->stop_matching = 0;
-    color_line->cached = 0;
-  }
+  mutt_color_prefilter(color_list, buf);
 
   do
   {
@@ -828,6 +1050,7 @@ match_body_patterns(char *buf, struct line_t *lineInfo, int n)
         }
         else
         {
+          color_line->regexec_calls++;
           if (regexec(&color_line->rx, buf + offset, 1, pmatch,
                       (offset ? REG_NOTBOL : 0)) == 0)
           {
@@ -941,8 +1164,12 @@ resolve_types(char *buf, char *raw, struct line_t *lineInfo, int n, int last,
        */
       if (!option(OPTHEADERCOLORPARTIAL))
       {
+        mutt_color_prefilter(ColorHdrList, buf);
         for (color_line = ColorHdrList; color_line; color_line = color_line->next)
         {
+          if (color_line->stop_matching)
+            continue;
+          color_line->regexec_calls++;
           if (REGEXEC(color_line->rx, buf) == 0)
           {
             lineInfo[n].type = MT_COLOR_HEADER;
@@ -1246,7 +1473,7 @@ static int resolve_show_patterns(FILE *f, LOFF_T *last_pos, struct line_t *lineI
   if ((lineInfo[m].type == MT_COLOR_QUOTED) &&
       (lineInfo[m].quote == NULL))
   {
-    regexec((regex_t *) QuoteRegexp.rx, tmp_fmt, 1, pmatch, 0);
+    mutt_regexec(&QuoteRegexp, tmp_fmt, 1, pmatch, 0);
     lineInfo[m].quote = classify_quote(QuoteList,
                                        tmp_fmt + pmatch[0].rm_so,
                                        pmatch[0].rm_eo - pmatch[0].rm_so,
@@ -1514,7 +1741,7 @@ static int
 display_line(FILE *f, LOFF_T *last_pos, struct line_t **lineInfo, int n,
              int *last, int *max, int flags, struct q_class_t **QuoteList,
              int *q_level, int *force_redraw, regex_t *SearchRE,
-             mutt_window_t *pager_window)
+             mutt_window_t *pager_window, struct pager_classes_t *classes)
 {
   unsigned char *buf = NULL, *fmt = NULL;
   size_t buflen = 0;
@@ -1535,7 +1762,9 @@ display_line(FILE *f, LOFF_T *last_pos, struct line_t **lineInfo, int n,
 
   if (*last == *max)
   {
-    safe_realloc(lineInfo, sizeof(struct line_t) * (*max += LINES));
+    /* grow geometrically: laying out a huge message would otherwise copy
+     * the whole array every screenful */
+    safe_realloc(lineInfo, sizeof(struct line_t) * (*max += MAX(*max, LINES)));
     for (ch = *last; ch < *max ; ch++)
     {
       memset(&((*lineInfo)[ch]), 0, sizeof(struct line_t));
@@ -1551,7 +1780,6 @@ display_line(FILE *f, LOFF_T *last_pos, struct line_t **lineInfo, int n,
   {
     if ((*lineInfo)[n].type == -1)
     {
-      /* determine the line class */
       if (fill_buffer(f, last_pos, (*lineInfo)[n].offset, &buf, &fmt, &buflen, &buf_ready) < 0)
       {
         if (change_last)
@@ -1559,8 +1787,48 @@ display_line(FILE *f, LOFF_T *last_pos, struct line_t **lineInfo, int n,
         goto out;
       }
 
-      resolve_types((char *) fmt, (char *) buf, *lineInfo, n, *last,
-                    QuoteList, q_level, force_redraw, flags & MUTT_SHOWCOLOR);
+      /* determine the line class, unless an earlier pass already did */
+      m = (*lineInfo)[n].continuation ? 0 :
+        restore_line_class(classes, *lineInfo, n, buf);
+      if (m < 0)
+      {
+        /* The lines above were restored from a different text, and the
+         * quote classes along with them: classify them all over again. */
+        cleanup_quote(QuoteList);
+        *q_level = 0;
+        for (m = 0; m < n; m++)
+        {
+          (*lineInfo)[m].type = -1;
+          (*lineInfo)[m].chunks = 0;
+          (*lineInfo)[m].is_cont_hdr = 0;
+          (*lineInfo)[m].show_patterns_done = 0;
+          (*lineInfo)[m].quote = NULL;
+        }
+        for (m = 0; m < n; m++)
+          display_line(f, last_pos, lineInfo, m, last, max,
+                       flags & (MUTT_TYPES | MUTT_SHOWCOLOR), QuoteList, q_level,
+                       force_redraw, SearchRE, pager_window, NULL);
+        *force_redraw = 1;
+
+        /* fill_buffer() keeps the length of the line it read last */
+        FREE(&buf);
+        FREE(&fmt);
+        buflen = 0;
+        buf_ready = 0;
+        if (fill_buffer(f, last_pos, (*lineInfo)[n].offset, &buf, &fmt, &buflen, &buf_ready) < 0)
+        {
+          if (change_last)
+            (*last)--;
+          goto out;
+        }
+        m = 0;
+      }
+      if (!m)
+      {
+        resolve_types((char *) fmt, (char *) buf, *lineInfo, n, *last,
+                      QuoteList, q_level, force_redraw, flags & MUTT_SHOWCOLOR);
+        (*lineInfo)[n].sum = line_sum(buf);
+      }
 
       /* avoid race condition for continuation lines when scrolling up */
       for (m = n + 1; m < *last && (*lineInfo)[m].offset && (*lineInfo)[m].continuation; m++)
@@ -1786,6 +2054,8 @@ typedef struct
   int hideQuoted;
   int q_level;
   struct q_class_t *QuoteList;
+  struct pager_classes_t *classes;
+  int layout_done;              /* lineInfo reaches the end of the file */
   LOFF_T last_pos;
   LOFF_T last_offset;
   mutt_window_t *index_status_window;
@@ -1805,6 +2075,45 @@ typedef struct
   struct stat sb;
 } pager_redraw_data_t;
 
+#ifdef DEBUG
+/* Log how much work each color pattern has been so far. */
+static void log_color_costs(const char *object, COLOR_LINE *list)
+{
+  for (; list; list = list->next)
+    muttdbg(2, "color %s \"%s\": %lu regexec calls, %lu lines skipped by \"%s\"",
+            object, list->pattern, list->regexec_calls, list->prefilter_skips,
+            NONULL(list->literal));
+}
+#endif
+
+/* the innermost pager, for mutt_pager_layout_pending() */
+static pager_redraw_data_t *CurrentPager = NULL;
+
+/* Returns 1 if the pager has a message left to lay out while idle. */
+int mutt_pager_layout_pending(void)
+{
+  return PagerReadAhead > 0 && CurrentPager && !CurrentPager->layout_done;
+}
+
+/* Lay out the next $pager_read_ahead lines past the end of lineInfo,
+ * using the same flags as jumping to the bottom. */
+static void
+pager_layout_ahead(pager_redraw_data_t *rd)
+{
+  int i;
+
+  for (i = 0; i < PagerReadAhead; i++)
+    if (display_line(rd->fp, &rd->last_pos, &rd->lineInfo, rd->lastLine,
+                     &rd->lastLine, &rd->maxLine,
+                     rd->has_types | rd->SearchFlag | (rd->flags & MUTT_PAGER_NOWRAP),
+                     &rd->QuoteList, &rd->q_level, &rd->force_redraw,
+                     &rd->SearchRE, rd->pager_window, rd->classes) != 0)
+    {
+      rd->layout_done = 1;
+      break;
+    }
+}
+
 static void pager_menu_redraw(MUTTMENU *pager_menu)
 {
   pager_redraw_data_t *rd = pager_menu->redraw_data;
@@ -1823,6 +2132,8 @@ static void pager_menu_redraw(MUTTMENU *pager_menu)
     /* clear() doesn't optimize screen redraws */
     move(0, 0);
     clrtobot();
+    if (rd->index)
+      menu_invalidate_rows(rd->index);
 
     if (IsHeader(rd->extra) && Context->vcount + 1 < PagerIndexLines)
       rd->indexlen = Context->vcount + 1;
@@ -1935,6 +2246,12 @@ static void pager_menu_redraw(MUTTMENU *pager_menu)
   {
     if (!(rd->flags & MUTT_PAGER_RETWINCH))
     {
+      if (rd->classes)
+      {
+        save_line_classes(rd->classes, rd->lineInfo, rd->lastLine);
+        rd->classes->gen = PagerClassGen;
+      }
+
       rd->lines = -1;
       for (i = 0; i <= rd->topline; i++)
         if (!rd->lineInfo[i].continuation)
@@ -1958,13 +2275,14 @@ static void pager_menu_redraw(MUTTMENU *pager_menu)
 
       rd->lastLine = 0;
       rd->topline = 0;
+      rd->layout_done = 0;
     }
     i = -1;
     j = -1;
     while (display_line(rd->fp, &rd->last_pos, &rd->lineInfo, ++i, &rd->lastLine, &rd->maxLine,
                         rd->has_types | rd->SearchFlag | (rd->flags & MUTT_PAGER_NOWRAP),
                         &rd->QuoteList, &rd->q_level, &rd->force_redraw,
-                        &rd->SearchRE, rd->pager_window) == 0)
+                        &rd->SearchRE, rd->pager_window, rd->classes) == 0)
       if (!rd->lineInfo[i].continuation && ++j == rd->lines)
       {
         rd->topline = i;
@@ -1996,7 +2314,7 @@ static void pager_menu_redraw(MUTTMENU *pager_menu)
                          &rd->maxLine,
                          (rd->flags & MUTT_DISPLAYFLAGS) | rd->hideQuoted | rd->SearchFlag | (rd->flags & MUTT_PAGER_NOWRAP),
                          &rd->QuoteList, &rd->q_level, &rd->force_redraw, &rd->SearchRE,
-                         rd->pager_window) > 0)
+                         rd->pager_window, rd->classes) > 0)
           rd->lines++;
         rd->curline++;
         mutt_window_move(rd->pager_window, rd->lines, 0);
@@ -2102,7 +2420,7 @@ mutt_pager(const char *banner, const char *fname, int flags, pager_t *extra)
   int old_PagerIndexLines;              /* some people want to resize it
                                          * while inside the pager... */
 
-  pager_redraw_data_t rd;
+  pager_redraw_data_t rd, *prev_pager;
 
   if (!(flags & MUTT_SHOWCOLOR))
     flags |= MUTT_SHOWFLAT;
@@ -2130,6 +2448,17 @@ mutt_pager(const char *banner, const char *fname, int flags, pager_t *extra)
   }
   unlink(fname);
 
+  if (rd.has_types)
+  {
+    rd.classes = get_pager_classes(extra ? extra->hdr : NULL,
+                                   extra ? extra->bdy : NULL, rd.sb.st_size,
+                                   rd.has_types |
+                                   (flags & (MUTT_SHOWCOLOR | MUTT_SHOWFLAT)));
+    rd.QuoteList = rd.classes->QuoteList;
+    rd.q_level = rd.classes->q_level;
+    rd.classes->QuoteList = NULL;
+  }
+
   /* Initialize variables */
 
   if (IsHeader(extra) && !extra->hdr->read)
@@ -2175,6 +2504,9 @@ mutt_pager(const char *banner, const char *fname, int flags, pager_t *extra)
   pager_menu->redraw_data = &rd;
   mutt_push_current_menu(pager_menu);
 
+  prev_pager = CurrentPager;
+  CurrentPager = &rd;
+
   while (ch != -1)
   {
     mutt_curs_set(0);
@@ -2247,14 +2579,19 @@ mutt_pager(const char *banner, const char *fname, int flags, pager_t *extra)
     ch = km_dokey(MENU_PAGER);
     if (ch >= 0)
       mutt_clear_error();
-    mutt_curs_set(1);
 
     if (ch < 0)
     {
+      /* while idle, lay out more of the message.  The cursor stays
+       * hidden, or polling would make it flicker. */
+      if (ch == -2 && mutt_pager_layout_pending())
+        pager_layout_ahead(&rd);
       ch = 0;
       continue;
     }
 
+    mutt_curs_set(1);
+
     rc = ch;
 
     switch (ch)
@@ -2493,7 +2830,8 @@ search_next:
           while (display_line(rd.fp, &rd.last_pos, &rd.lineInfo, i, &rd.lastLine,
                               &rd.maxLine, MUTT_SEARCH | (flags & MUTT_PAGER_NSKIP) | (flags & MUTT_PAGER_NOWRAP) | rd.has_types,
                               &rd.QuoteList, &rd.q_level,
-                              &rd.force_redraw, &rd.SearchRE, rd.pager_window) == 0)
+                              &rd.force_redraw, &rd.SearchRE, rd.pager_window,
+                              rd.classes) == 0)
             i++;
 
           if (!rd.SearchBack)
@@ -2604,7 +2942,8 @@ search_next:
             while ((new_topline < rd.lastLine ||
                     (0 == (dretval = display_line(rd.fp, &rd.last_pos, &rd.lineInfo,
                            new_topline, &rd.lastLine, &rd.maxLine, MUTT_TYPES | (flags & MUTT_PAGER_NOWRAP),
-                           &rd.QuoteList, &rd.q_level, &rd.force_redraw, &rd.SearchRE, rd.pager_window))))
+                           &rd.QuoteList, &rd.q_level, &rd.force_redraw, &rd.SearchRE, rd.pager_window,
+                           rd.classes))))
                    && rd.lineInfo[new_topline].type == MT_COLOR_QUOTED)
             {
               new_topline++;
@@ -2624,7 +2963,8 @@ search_next:
             while ((new_topline < rd.lastLine ||
                     (0 == (dretval = display_line(rd.fp, &rd.last_pos, &rd.lineInfo,
                            new_topline, &rd.lastLine, &rd.maxLine, MUTT_TYPES | (flags & MUTT_PAGER_NOWRAP),
-                           &rd.QuoteList, &rd.q_level, &rd.force_redraw, &rd.SearchRE, rd.pager_window))))
+                           &rd.QuoteList, &rd.q_level, &rd.force_redraw, &rd.SearchRE, rd.pager_window,
+                           rd.classes))))
                    && rd.lineInfo[new_topline].type != MT_COLOR_QUOTED)
               new_topline++;
 
@@ -2637,7 +2977,8 @@ search_next:
             while ((new_topline < rd.lastLine ||
                     (0 == (dretval = display_line(rd.fp, &rd.last_pos, &rd.lineInfo,
                            new_topline, &rd.lastLine, &rd.maxLine, MUTT_TYPES | (flags & MUTT_PAGER_NOWRAP),
-                           &rd.QuoteList, &rd.q_level, &rd.force_redraw, &rd.SearchRE, rd.pager_window))))
+                           &rd.QuoteList, &rd.q_level, &rd.force_redraw, &rd.SearchRE, rd.pager_window,
+                           rd.classes))))
                    && rd.lineInfo[new_topline].type == MT_COLOR_QUOTED)
             {
               new_topline++;
@@ -2674,7 +3015,8 @@ search_next:
           while ((new_topline < rd.lastLine ||
                   (0 == (dretval = display_line(rd.fp, &rd.last_pos, &rd.lineInfo,
                          new_topline, &rd.lastLine, &rd.maxLine, MUTT_TYPES | (flags & MUTT_PAGER_NOWRAP),
-                         &rd.QuoteList, &rd.q_level, &rd.force_redraw, &rd.SearchRE, rd.pager_window))))
+                         &rd.QuoteList, &rd.q_level, &rd.force_redraw, &rd.SearchRE, rd.pager_window,
+                           rd.classes))))
                  && ISHEADER(rd.lineInfo[new_topline].type))
             new_topline++;
 
@@ -2701,7 +3043,7 @@ search_next:
           while (display_line(rd.fp, &rd.last_pos, &rd.lineInfo, i, &rd.lastLine,
                               &rd.maxLine, rd.has_types | (flags & MUTT_PAGER_NOWRAP),
                               &rd.QuoteList, &rd.q_level, &rd.force_redraw,
-                              &rd.SearchRE, rd.pager_window) == 0)
+                              &rd.SearchRE, rd.pager_window, rd.classes) == 0)
             i++;
           rd.topline = upNLines(rd.pager_window->rows, rd.lineInfo, rd.lastLine, rd.hideQuoted);
         }
@@ -3199,7 +3541,15 @@ search_next:
     }
   }
 
-  cleanup_quote(&rd.QuoteList);
+  if (rd.classes)
+  {
+    save_line_classes(rd.classes, rd.lineInfo, rd.lastLine);
+    rd.classes->QuoteList = rd.QuoteList;
+    rd.classes->q_level = rd.q_level;
+    put_pager_classes(rd.classes);
+  }
+  else
+    cleanup_quote(&rd.QuoteList);
 
   for (i = 0; i < rd.maxLine ; i++)
   {
@@ -3213,6 +3563,11 @@ search_next:
     rd.SearchCompiled = 0;
   }
   FREE(&rd.lineInfo);
+  CurrentPager = prev_pager;
+#ifdef DEBUG
+  log_color_costs("header", ColorHdrList);
+  log_color_costs("body", ColorBodyList);
+#endif
   mutt_pop_current_menu(pager_menu);
   mutt_menuDestroy(&pager_menu);
   if (rd.index)
@@ -43,12 +43,71 @@ static BODY *_parse_messageRFC822(FILE *fp, BODY *parent, int *counter);
 static BODY *_parse_multipart(FILE *fp, const char *boundary, LOFF_T end_off,
                               int digest, int *counter);
 
+/* Where a header is read from: a stream, or for
+ * mutt_read_rfc822_header_buf() the span [buf, end).  The span functions
+ * mirror their stdio counterparts exactly, so both give the same result. */
+typedef struct
+{
+  FILE *fp;
+  const char *buf;
+  const char *pos;
+  const char *end;
+} HDR_SOURCE;
 
-/* Reads an arbitrarily long header field, and looks ahead for continuation
- * lines.  ``line'' must point to a dynamically allocated string; it is
- * increased if more space is required to fit the whole line.
- */
-char *mutt_read_rfc822_line(FILE *f, char *line, size_t *linelen)
+static char *src_gets(char *s, size_t n, HDR_SOURCE *src)
+{
+  const char *nl;
+  size_t len;
+
+  if (src->fp)
+    return fgets(s, n, src->fp);
+
+  if (src->pos >= src->end)
+    return NULL;
+
+  len = MIN((size_t) (src->end - src->pos), n - 1);
+  if ((nl = memchr(src->pos, '\n', len)))
+    len = nl - src->pos + 1;
+  memcpy(s, src->pos, len);
+  s[len] = 0;
+  src->pos += len;
+
+  return s;
+}
+
+static int src_getc(HDR_SOURCE *src)
+{
+  if (src->fp)
+    return fgetc(src->fp);
+
+  return (src->pos < src->end) ? (unsigned char) *src->pos++ : EOF;
+}
+
+static void src_ungetc(int ch, HDR_SOURCE *src)
+{
+  if (src->fp)
+    ungetc(ch, src->fp);
+  else if (ch != EOF)
+    src->pos--;
+}
+
+static LOFF_T src_tell(HDR_SOURCE *src)
+{
+  if (src->fp)
+    return ftello(src->fp);
+
+  return src->pos - src->buf;
+}
+
+static void src_seek(HDR_SOURCE *src, LOFF_T loc)
+{
+  if (src->fp)
+    fseeko(src->fp, loc, SEEK_SET);
+  else
+    src->pos = src->buf + loc;
+}
+
+static char *read_rfc822_line(HDR_SOURCE *src, char *line, size_t *linelen)
 {
   char *buf = line;
   int ch;
@@ -57,7 +116,7 @@ char *mutt_read_rfc822_line(FILE *f, char *line, size_t *linelen)
 
   FOREVER
   {
-    if (fgets(buf, *linelen - offset, f) == NULL ||    /* end of file or */
+    if (src_gets(buf, *linelen - offset, src) == NULL || /* end of file or */
         (is_email_wsp(*line) && !offset))              /* end of headers */
     {
       *line = 0;
@@ -77,16 +136,16 @@ char *mutt_read_rfc822_line(FILE *f, char *line, size_t *linelen)
                          * it begins with a non-space */
 
       /* check to see if the next line is a continuation line */
-      if ((ch = fgetc(f)) != ' ' && ch != '\t')
+      if ((ch = src_getc(src)) != ' ' && ch != '\t')
       {
-        ungetc(ch, f);
+        src_ungetc(ch, src);
         return (line); /* next line is a separate header field or EOH */
       }
 
       /* eat tabs and spaces from the beginning of the continuation line */
-      while ((ch = fgetc(f)) == ' ' || ch == '\t')
+      while ((ch = src_getc(src)) == ' ' || ch == '\t')
         ;
-      ungetc(ch, f);
+      src_ungetc(ch, src);
       *++buf = ' '; /* string is still terminated because we removed
                        at least one whitespace char above */
     }
@@ -104,6 +163,17 @@ char *mutt_read_rfc822_line(FILE *f, char *line, size_t *linelen)
   /* not reached */
 }
 
+/* Reads an arbitrarily long header field, and looks ahead for continuation
+ * lines.  ``line'' must point to a dynamically allocated string; it is
+ * increased if more space is required to fit the whole line.
+ */
+char *mutt_read_rfc822_line(FILE *f, char *line, size_t *linelen)
+{
+  HDR_SOURCE src = { .fp = f };
+
+  return read_rfc822_line(&src, line, linelen);
+}
+
 LIST *mutt_parse_references(char *s, int allow_nb)
 {
   LIST *t, *lst = NULL;
@@ -1556,7 +1626,7 @@ done:
  *
  * Args:
  *
- * f            stream to read from
+ * src          stream or buffer to read from
  *
  * hdr          header structure of current message (optional).
  *
@@ -1570,8 +1640,8 @@ done:
  * Returns:     newly allocated envelope structure.  You should free it by
  *              mutt_free_envelope() when envelope stay unneeded.
  */
-ENVELOPE *mutt_read_rfc822_header(FILE *f, HEADER *hdr, short user_hdrs,
-                                  short weed)
+static ENVELOPE *read_rfc822_header(HDR_SOURCE *src, HEADER *hdr,
+                                    short user_hdrs, short weed)
 {
   ENVELOPE *e = mutt_new_envelope();
   LIST *last = NULL;
@@ -1598,8 +1668,8 @@ ENVELOPE *mutt_read_rfc822_header(FILE *f, HEADER *hdr, short user_hdrs,
     }
   }
 
-  while ((loc = ftello(f)),
-         *(line = mutt_read_rfc822_line(f, line, &linelen)) != 0)
+  while ((loc = src_tell(src)),
+         *(line = read_rfc822_line(src, line, &linelen)) != 0)
   {
     if ((p = strpbrk(line, ": \t")) == NULL || *p != ':')
     {
@@ -1616,7 +1686,7 @@ ENVELOPE *mutt_read_rfc822_header(FILE *f, HEADER *hdr, short user_hdrs,
         continue;
       }
 
-      fseeko(f, loc, SEEK_SET);
+      src_seek(src, loc);
       break; /* end of header */
     }
 
@@ -1675,7 +1745,7 @@ ENVELOPE *mutt_read_rfc822_header(FILE *f, HEADER *hdr, short user_hdrs,
   if (hdr)
   {
     hdr->content->hdr_offset = hdr->offset;
-    hdr->content->offset = ftello(f);
+    hdr->content->offset = src_tell(src);
 
     rfc2047_decode_envelope(e);
 
@@ -1683,7 +1753,7 @@ ENVELOPE *mutt_read_rfc822_header(FILE *f, HEADER *hdr, short user_hdrs,
     {
       regmatch_t pmatch[1];
 
-      if (regexec(ReplyRegexp.rx, e->subject, 1, pmatch, 0) == 0)
+      if (mutt_regexec(&ReplyRegexp, e->subject, 1, pmatch, 0) == 0)
         e->real_subj = e->subject + pmatch[0].rm_eo;
       else
         e->real_subj = e->subject;
@@ -1715,6 +1785,26 @@ ENVELOPE *mutt_read_rfc822_header(FILE *f, HEADER *hdr, short user_hdrs,
   return (e);
 }
 
+ENVELOPE *mutt_read_rfc822_header(FILE *f, HEADER *hdr, short user_hdrs,
+                                  short weed)
+{
+  HDR_SOURCE src = { .fp = f };
+
+  return read_rfc822_header(&src, hdr, user_hdrs, weed);
+}
+
+/* mutt_read_rfc822_header_buf() -- like mutt_read_rfc822_header(), but
+ * parses the len bytes at buf instead of a stream.  hdr->content->offset
+ * is set relative to buf.
+ */
+ENVELOPE *mutt_read_rfc822_header_buf(const char *buf, size_t len,
+                                      HEADER *hdr, short user_hdrs, short weed)
+{
+  HDR_SOURCE src = { .buf = buf, .pos = buf, .end = buf + len };
+
+  return read_rfc822_header(&src, hdr, user_hdrs, weed);
+}
+
 ADDRESS *mutt_parse_adrlist(ADDRESS *p, const char *s)
 {
   const char *q;
@@ -328,6 +328,133 @@ int mutt_which_case(const char *s)
   return REG_ICASE; /* case-insensitive */
 }
 
+/* Returns the longest run of characters that every match of the extended
+ * regular expression s has to contain, or NULL if there isn't one.  Only
+ * ASCII is collected, so that a REG_ICASE regex can be checked with
+ * tolower().  The analysis is conservative: anything it doesn't
+ * understand just ends the current run.  The result must be freed. */
+char *mutt_regex_literal(const char *s)
+{
+  char *run, *best = NULL;
+  size_t rlen = 0, blen = 0;
+  int depth;
+
+  if (!s || !*s)
+    return NULL;
+
+  run = safe_malloc(strlen(s) + 1);
+
+#define END_RUN do {                                    \
+    if (rlen > blen)                                    \
+    {                                                   \
+      mutt_str_replace(&best, NULL);                    \
+      best = mutt_substrdup(run, run + rlen);           \
+      blen = rlen;                                      \
+    }                                                   \
+    rlen = 0;                                           \
+  } while (0)
+
+  for (; *s; s++)
+  {
+    switch (*s)
+    {
+      case '|':
+        /* alternation at the top level: nothing is required */
+        goto none;
+
+      case '(':
+        END_RUN;
+        for (depth = 1, s++; *s && depth; s++)
+        {
+          if (*s == '\\' && s[1])
+            s++;
+          else if (*s == '(')
+            depth++;
+          else if (*s == ')')
+            depth--;
+        }
+        if (depth)
+          goto none;
+        s--;
+        break;
+
+      case '[':
+        END_RUN;
+        s++;
+        if (*s == '^')
+          s++;
+        if (*s == ']')
+          s++;
+        for (; *s && *s != ']'; s++)
+          if (*s == '[' && (s[1] == ':' || s[1] == '.' || s[1] == '='))
+          {
+            char c = s[1];
+
+            for (s += 2; *s && !(*s == c && s[1] == ']'); s++)
+              ;
+            if (!*s)
+              goto none;
+            s++;
+          }
+        if (!*s)
+          goto none;
+        break;
+
+      case '*':
+      case '?':
+      case '{':
+        /* the previous character may not be there at all */
+        if (rlen)
+          rlen--;
+        END_RUN;
+        if (*s == '{' && strchr(s, '}'))
+          s = strchr(s, '}');
+        break;
+
+      case '+':
+        /* unless another repetition makes it optional after all */
+        if (rlen && s[1] && strchr("*?{+", s[1]))
+          rlen--;
+        END_RUN;
+        break;
+
+      case '.':
+      case '^':
+      case '$':
+        END_RUN;
+        break;
+
+      case '\\':
+        s++;
+        if (!*s || *s == '|')
+          goto none;
+        if (isalnum((unsigned char) *s) || strchr("<>`'", *s))
+          END_RUN;
+        else
+          run[rlen++] = *s;
+        break;
+
+      default:
+        if ((unsigned char) *s & 0x80)
+          END_RUN;
+        else
+          run[rlen++] = *s;
+        break;
+    }
+  }
+  END_RUN;
+
+#undef END_RUN
+
+  FREE(&run);
+  return best;
+
+none:
+  FREE(&run);
+  FREE(&best);
+  return NULL;
+}
+
 static int
 msg_search(CONTEXT *ctx, pattern_t *pat, int msgno)
 {
@@ -556,8 +683,10 @@ static int eat_regexp(pattern_t *pat, int flags, BUFFER *s, BUFFER *err)
   }
   else
   {
+    int icase = mutt_which_case(buf.data);
+
     pat->p.rx = safe_malloc(sizeof(regex_t));
-    r = REGCOMP(pat->p.rx, buf.data, REG_NEWLINE | REG_NOSUB | mutt_which_case(buf.data));
+    r = REGCOMP(pat->p.rx, buf.data, REG_NEWLINE | REG_NOSUB | icase);
     if (r)
     {
       regerror(r, pat->p.rx, errmsg, sizeof(errmsg));
@@ -566,6 +695,8 @@ static int eat_regexp(pattern_t *pat, int flags, BUFFER *s, BUFFER *err)
       FREE(&pat->p.rx);
       return (-1);
     }
+    pat->literal = mutt_regex_literal(buf.data);
+    pat->ign_case = icase == REG_ICASE;
     FREE(&buf.data);
   }
 
@@ -1053,6 +1184,8 @@ static int patmatch(const pattern_t *pat, const char *buf)
       !strstr(buf, pat->p.str);
   else if (pat->groupmatch)
     return !mutt_group_match(pat->p.g, buf);
+  else if (mutt_regexec_skip(pat->literal, pat->ign_case, buf))
+    return REG_NOMATCH;
   else
     return regexec(pat->p.rx, buf, 0, NULL, 0);
 }
@@ -1138,6 +1271,7 @@ void mutt_pattern_free(pattern_t **pat)
       regfree(tmp->p.rx);
       FREE(&tmp->p.rx);
     }
+    FREE(&tmp->literal);
 
     if (tmp->child)
       mutt_pattern_free(&tmp->child);
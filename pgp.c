@@ -195,7 +195,7 @@ static int pgp_copy_checksig(FILE *fpin, FILE *fpout)
 
     while ((line = mutt_read_line(line, &linelen, fpin, &lineno, 0)) != NULL)
     {
-      if (regexec(PgpGoodSign.rx, line, 0, NULL, 0) == 0)
+      if (mutt_regexec(&PgpGoodSign, line, 0, NULL, 0) == 0)
       {
         muttdbg(2, "\"%s\" matches regexp.", line);
         rv = 0;
@@ -236,7 +236,7 @@ static int pgp_check_pgp_decryption_okay_regexp(FILE *fpin)
 
     while ((line = mutt_read_line(line, &linelen, fpin, &lineno, 0)) != NULL)
     {
-      if (regexec(PgpDecryptionOkay.rx, line, 0, NULL, 0) == 0)
+      if (mutt_regexec(&PgpDecryptionOkay, line, 0, NULL, 0) == 0)
       {
         muttdbg(2, "\"%s\" matches regexp.", line);
         rv = 0;
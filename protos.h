@@ -110,6 +110,7 @@ HASH *mutt_make_subj_hash(CONTEXT *);
 
 char *mutt_read_rfc822_line(FILE *, char *, size_t *);
 ENVELOPE *mutt_read_rfc822_header(FILE *, HEADER *, short, short);
+ENVELOPE *mutt_read_rfc822_header_buf(const char *, size_t, HEADER *, short, short);
 
 int mutt_check_month(const char *);
 const char *mutt_ctime(const time_t *t);
@@ -160,6 +161,7 @@ char *mutt_gen_msgid(ENVELOPE *);
 char *mutt_get_body_charset(char *, size_t, BODY *);
 const char *mutt_get_name(ADDRESS *);
 char *mutt_get_parameter(const char *, PARAMETER *);
+char *mutt_regex_literal(const char *);
 LIST *mutt_crypt_hook(ADDRESS *);
 void mutt_make_date(BUFFER *);
 
@@ -203,6 +205,7 @@ void mutt_check_stats(void);
 int mutt_count_body_parts(CONTEXT *, HEADER *);
 void mutt_check_rescore(CONTEXT *);
 void mutt_clear_error(void);
+void mutt_clear_pager_cache(void);
 void mutt_clear_pager_position(void);
 void mutt_commands_cleanup(void);
 void mutt_create_alias(ENVELOPE *, ADDRESS *);
@@ -244,11 +247,16 @@ void mutt_free_envelope(ENVELOPE **);
 void mutt_free_header(HEADER **);
 void mutt_free_parameter(PARAMETER **);
 void mutt_free_regexp(REGEXP **);
+void mutt_set_regexp_literal(REGEXP *, const char *, int);
+int mutt_regexec(const REGEXP *, const char *, size_t, regmatch_t [], int);
+int mutt_regexec_skip(const char *, int, const char *);
+void mutt_log_regexec_stats(void);
 void mutt_generate_header(char *, size_t, HEADER *, int);
 const char *mutt_getcwd(BUFFER *);
 void mutt_help(int);
 const char *mutt_idxfmt_hook(const char *, CONTEXT *, HEADER *);
 void mutt_draw_tree(CONTEXT *);
+void mutt_draw_thread(CONTEXT *, HEADER *);
 void mutt_check_lookup_list(BODY *, char *, size_t);
 void mutt_list_menu(CONTEXT *ctx, HEADER *cur);
 void mutt_make_help(char *, size_t, const char *, int, int);
@@ -334,6 +342,7 @@ int mutt_edit_message(CONTEXT *, HEADER *);
 int mutt_chscmp(const char *s, const char *chs);
 #define mutt_is_utf8(a) mutt_chscmp(a, "utf-8")
 #define mutt_is_us_ascii(a) mutt_chscmp(a, "us-ascii")
+int mutt_pager_layout_pending(void);
 int mutt_parent_message(CONTEXT *, HEADER *, int);
 int mutt_prepare_template(FILE*, CONTEXT *, HEADER *, HEADER *, short);
 int mutt_enter_filename(const char *prompt, BUFFER *fname);
@@ -351,6 +360,8 @@ int mutt_get_tmp_attachment(BODY *);
 void mutt_filter_commandline_header_tag(char *);
 void mutt_filter_commandline_header_value(char *);
 int mutt_index_menu(void);
+void mutt_invalidate_index_lines(void);
+unsigned int mutt_index_lines_gen(void);
 int mutt_invoke_sendmail(ADDRESS *, ADDRESS *, ADDRESS *, ADDRESS *, const char *, int);
 int mutt_is_mail_list(ADDRESS *);
 int mutt_is_message_type(int, const char *);
@@ -79,13 +79,13 @@ static size_t convert_string(ICONV_CONST char *f, size_t flen,
   size_t obl, n;
   int e;
 
-  cd = mutt_iconv_open(to, from, 0);
+  cd = mutt_iconv_open_cached(to, from, 0);
   if (cd == (iconv_t)(-1))
     return (size_t)(-1);
 
   if (flen >= SIZE_MAX / MB_LEN_MAX)
   {
-    iconv_close(cd);
+    mutt_iconv_release(cd);
     return (size_t)(-1);
   }
 
@@ -96,7 +96,7 @@ static size_t convert_string(ICONV_CONST char *f, size_t flen,
   {
     e = errno;
     FREE(&buf);
-    iconv_close(cd);
+    mutt_iconv_release(cd);
     errno = e;
     return (size_t)(-1);
   }
@@ -106,7 +106,7 @@ static size_t convert_string(ICONV_CONST char *f, size_t flen,
 
   safe_realloc(&buf, ob - buf + 1);
   *t = buf;
-  iconv_close(cd);
+  mutt_iconv_release(cd);
 
   return n;
 }
@@ -303,18 +303,18 @@ static size_t try_block(ICONV_CONST char *d, size_t dlen,
 
   if (fromcode)
   {
-    cd = mutt_iconv_open(tocode, fromcode, 0);
+    cd = mutt_iconv_open_cached(tocode, fromcode, 0);
     assert(cd != (iconv_t)(-1));
     ib = d, ibl = dlen, ob = buf1, obl = sizeof(buf1) - strlen(tocode);
     if (iconv(cd, &ib, &ibl, &ob, &obl) == (size_t)(-1) ||
         iconv(cd, 0, 0, &ob, &obl) == (size_t)(-1))
     {
       assert(errno == E2BIG);
-      iconv_close(cd);
+      mutt_iconv_release(cd);
       assert(ib > d);
       return (ib - d == dlen) ? dlen : ib - d + 1;
     }
-    iconv_close(cd);
+    mutt_iconv_release(cd);
   }
   else
   {
@@ -373,13 +373,13 @@ static size_t encode_block(char *s, char *d, size_t dlen,
 
   if (fromcode)
   {
-    cd = mutt_iconv_open(tocode, fromcode, 0);
+    cd = mutt_iconv_open_cached(tocode, fromcode, 0);
     assert(cd != (iconv_t)(-1));
     ib = d, ibl = dlen, ob = buf1, obl = sizeof(buf1) - strlen(tocode);
     n1 = iconv(cd, &ib, &ibl, &ob, &obl);
     n2 = iconv(cd, 0, 0, &ob, &obl);
     assert(n1 != (size_t)(-1) && n2 != (size_t)(-1));
-    iconv_close(cd);
+    mutt_iconv_release(cd);
     return (*encoder)(s, buf1, ob - buf1, tocode);
   }
   else
@@ -26,6 +26,7 @@
 #include "keymap.h"
 #include "mime.h"
 #include "mailbox.h"
+#include "mx.h"
 #include "copy.h"
 #include "mutt_crypt.h"
 #include "mutt_idna.h"
@@ -39,6 +40,10 @@
 #include "autocrypt.h"
 #endif
 
+#ifdef USE_IMAP
+#include "imap.h"
+#endif
+
 #include <ctype.h>
 #include <stdlib.h>
 #include <locale.h>
@@ -1590,7 +1595,7 @@ static int has_attach_keyword(char *filename)
   while ((buf = mutt_read_line(buf, &blen, fp, NULL, 0)) != NULL)
   {
     if (!mutt_is_quote_line(buf, NULL) &&
-        regexec(AbortNoattachRegexp.rx, buf, 0, NULL, 0) == 0)
+        mutt_regexec(&AbortNoattachRegexp, buf, 0, NULL, 0) == 0)
     {
       match = 1;
       break;
@@ -1951,6 +1956,19 @@ static int send_message_setup(SEND_CONTEXT *sctx, const char *tempfile,
     }
   }
 
+#ifdef USE_IMAP
+  /* $imap_lazy_headers may have left out fields that the reply envelope,
+   * $reverse_name and the reply-, send- and fcc-hooks look at */
+  if (ctx && ctx->magic == MUTT_IMAP &&
+      !(sctx->flags & (SENDPOSTPONED|SENDRESEND)) &&
+      (sctx->flags & (SENDREPLY | SENDFORWARD | SENDTOSENDER)) &&
+      imap_complete_headers(ctx, sctx->cur, 1) < 0)
+  {
+    mutt_error _("Could not fetch the headers of the selected messages.");
+    goto cleanup;
+  }
+#endif
+
   /* this is handled here so that the user can match ~f in send-hook */
   if (option(OPTREVNAME) && ctx &&
       !(sctx->flags & (SENDPOSTPONED|SENDRESEND)) &&
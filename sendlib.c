@@ -232,44 +232,35 @@ static void encode_quoted(FGETCONV * fc, FILE *fout, int istext)
 static char b64_buffer[3];
 static short b64_num;
 static short b64_linelen;
+/* the current output line, written out whole instead of a character at
+ * a time */
+static char b64_line[76];
 
 static void b64_flush(FILE *fout)
 {
   short i;
+  char *p;
 
   if (!b64_num)
     return;
 
   if (b64_linelen >= 72)
   {
-    fputc('\n', fout);
+    b64_line[b64_linelen++] = '\n';
+    fwrite(b64_line, 1, b64_linelen, fout);
     b64_linelen = 0;
   }
 
   for (i = b64_num; i < 3; i++)
     b64_buffer[i] = '\0';
 
-  fputc(B64Chars[(b64_buffer[0] >> 2) & 0x3f], fout);
-  b64_linelen++;
-  fputc(B64Chars[((b64_buffer[0] & 0x3) << 4) | ((b64_buffer[1] >> 4) & 0xf) ], fout);
-  b64_linelen++;
-
-  if (b64_num > 1)
-  {
-    fputc(B64Chars[((b64_buffer[1] & 0xf) << 2) | ((b64_buffer[2] >> 6) & 0x3) ], fout);
-    b64_linelen++;
-    if (b64_num > 2)
-    {
-      fputc(B64Chars[b64_buffer[2] & 0x3f], fout);
-      b64_linelen++;
-    }
-  }
-
-  while (b64_linelen % 4)
-  {
-    fputc('=', fout);
-    b64_linelen++;
-  }
+  p = b64_line + b64_linelen;
+  p[0] = B64Chars[(b64_buffer[0] >> 2) & 0x3f];
+  p[1] = B64Chars[((b64_buffer[0] & 0x3) << 4) | ((b64_buffer[1] >> 4) & 0xf) ];
+  p[2] = (b64_num > 1) ?
+    B64Chars[((b64_buffer[1] & 0xf) << 2) | ((b64_buffer[2] >> 6) & 0x3) ] : '=';
+  p[3] = (b64_num > 2) ? B64Chars[b64_buffer[2] & 0x3f] : '=';
+  b64_linelen += 4;
 
   b64_num = 0;
 }
@@ -298,7 +289,8 @@ static void encode_base64(FGETCONV * fc, FILE *fout, int istext)
     ch1 = ch;
   }
   b64_flush(fout);
-  fputc('\n', fout);
+  b64_line[b64_linelen++] = '\n';
+  fwrite(b64_line, 1, b64_linelen, fout);
 }
 
 static void encode_8bit(FGETCONV *fc, FILE *fout, int istext)
@@ -283,6 +283,8 @@ void mutt_sort_headers(CONTEXT *ctx, int init)
   if (!ctx)
     return;
 
+  mutt_invalidate_index_lines();
+
   if (!ctx->msgcount)
   {
     /* this function gets called by mutt_sync_mailbox(), which may have just
@@ -121,19 +121,19 @@ static void linearize_tree(CONTEXT *ctx)
  * nodes, whether a node itself is visible, whether, if invisible, it has
  * depth anyway, and whether any of its later siblings are roots of visible
  * subtrees.  while it's at it, it frees the old thread display, so we can
- * skip parts of the tree in mutt_draw_tree() if we've decided here that we
- * don't care about them any more.
+ * skip parts of the tree in draw_thread() if we've decided here that we
+ * don't care about them any more.  only the thread below the top-level
+ * node top is looked at, since the display of one thread never depends on
+ * its neighbours.
  */
-static void calculate_visibility(CONTEXT *ctx, int *max_depth)
+static void calculate_visibility(CONTEXT *ctx, THREAD *top, int *max_depth)
 {
-  THREAD *tmp, *tree = ctx->tree;
+  THREAD *tmp, *tree = top;
   int hide_top_missing = option(OPTHIDETOPMISSING) && !option(OPTHIDEMISSING);
   int hide_top_limited = option(OPTHIDETOPLIMITED) && !option(OPTHIDELIMITED);
   int depth = 0;
 
   /* we walk each level backwards to make it easier to compute next_subtree_visible */
-  while (tree->next)
-    tree = tree->next;
   *max_depth = 0;
 
   FOREVER
@@ -173,8 +173,8 @@ static void calculate_visibility(CONTEXT *ctx, int *max_depth)
       tree->visible = 0;
       tree->deep = !option(OPTHIDEMISSING);
     }
-    tree->next_subtree_visible = tree->next && (tree->next->next_subtree_visible
-                                                || tree->next->subtree_visible);
+    tree->next_subtree_visible = tree != top && tree->next &&
+      (tree->next->next_subtree_visible || tree->next->subtree_visible);
     if (tree->child)
     {
       depth++;
@@ -182,16 +182,16 @@ static void calculate_visibility(CONTEXT *ctx, int *max_depth)
       while (tree->next)
         tree = tree->next;
     }
-    else if (tree->prev)
+    else if (tree != top && tree->prev)
       tree = tree->prev;
     else
     {
-      while (tree && !tree->prev)
+      while (tree != top && !tree->prev)
       {
         depth--;
         tree = tree->parent;
       }
-      if (!tree)
+      if (tree == top)
         break;
       else
         tree = tree->prev;
@@ -201,7 +201,7 @@ static void calculate_visibility(CONTEXT *ctx, int *max_depth)
   /* now fix up for the OPTHIDETOP* options if necessary */
   if (hide_top_limited || hide_top_missing)
   {
-    tree = ctx->tree;
+    tree = top;
     FOREVER
     {
       if (!tree->visible && tree->deep && tree->subtree_visible < 2
@@ -209,13 +209,13 @@ static void calculate_visibility(CONTEXT *ctx, int *max_depth)
         tree->deep = 0;
       if (!tree->deep && tree->child && tree->subtree_visible)
         tree = tree->child;
-      else if (tree->next)
+      else if (tree != top && tree->next)
         tree = tree->next;
       else
       {
-        while (tree && !tree->next)
+        while (tree != top && !tree->next)
           tree = tree->parent;
-        if (!tree)
+        if (tree == top)
           break;
         else
           tree = tree->next;
@@ -224,6 +224,10 @@ static void calculate_visibility(CONTEXT *ctx, int *max_depth)
   }
 }
 
+/* bumped by mutt_draw_tree(); a top-level thread whose tree_gen differs
+ * has to be drawn again before its messages are displayed */
+static unsigned int TreeGen = 1;
+
 /* Since the graphics characters have a value >255, I have to resort to
  * using escape sequences to pass the information to print_enriched_string().
  * These are the macros MUTT_TREE_* defined in mutt.h.
@@ -232,18 +236,19 @@ static void calculate_visibility(CONTEXT *ctx, int *max_depth)
  * graphics chars on terminals which don't support them (see the man page
  * for curs_addch).
  */
-void mutt_draw_tree(CONTEXT *ctx)
+static void draw_thread(CONTEXT *ctx, THREAD *top)
 {
   char *pfx = NULL, *mypfx = NULL, *arrow = NULL, *myarrow = NULL, *new_tree;
   char corner = (Sort & SORT_REVERSE) ? MUTT_TREE_ULCORNER : MUTT_TREE_LLCORNER;
   char vtee = (Sort & SORT_REVERSE) ? MUTT_TREE_BTEE : MUTT_TREE_TTEE;
   int depth = 0, start_depth = 0, max_depth = 0, width = option(OPTNARROWTREE) ? 1 : 2;
-  THREAD *nextdisp = NULL, *pseudo = NULL, *parent = NULL, *tree = ctx->tree;
+  THREAD *nextdisp = NULL, *pseudo = NULL, *parent = NULL, *tree = top;
 
   /* Do the visibility calculations and free the old thread chars.
    * From now on we can simply ignore invisible subtrees
    */
-  calculate_visibility(ctx, &max_depth);
+  calculate_visibility(ctx, top, &max_depth);
+  top->tree_gen = TreeGen;
   pfx = safe_malloc(width * max_depth + 2);
   arrow = safe_malloc(width * max_depth + 2);
   while (tree)
@@ -306,7 +311,7 @@ void mutt_draw_tree(CONTEXT *ctx)
       }
       else
       {
-        while (!tree->next && tree->parent)
+        while (tree != top && !tree->next)
         {
           if (tree == pseudo)
             pseudo = NULL;
@@ -322,6 +327,11 @@ void mutt_draw_tree(CONTEXT *ctx)
             depth--;
           }
         }
+        if (tree == top)
+        {
+          tree = NULL;
+          break;
+        }
         if (tree == pseudo)
           pseudo = NULL;
         if (tree == nextdisp)
@@ -329,8 +339,6 @@ void mutt_draw_tree(CONTEXT *ctx)
         if (tree->visible)
           start_depth = depth;
         tree = tree->next;
-        if (!tree)
-          break;
       }
       if (!pseudo && tree->fake_thread)
         pseudo = tree;
@@ -344,6 +352,32 @@ void mutt_draw_tree(CONTEXT *ctx)
   FREE(&arrow);
 }
 
+/* The thread tree used to be drawn for the whole mailbox whenever it
+ * changed.  Now only the threads that are actually displayed get drawn,
+ * by mutt_draw_thread(), and the result is kept until the next call here.
+ */
+void mutt_draw_tree(CONTEXT *ctx)
+{
+  if (!++TreeGen)
+    TreeGen = 1;
+  mutt_invalidate_index_lines();
+}
+
+/* Makes sure hdr->tree and hdr->display_subject are up to date, drawing
+ * the thread hdr belongs to if that hasn't been done since the last
+ * mutt_draw_tree(). */
+void mutt_draw_thread(CONTEXT *ctx, HEADER *hdr)
+{
+  THREAD *top = hdr->thread;
+
+  if (!top)
+    return;
+  while (top->parent)
+    top = top->parent;
+  if (top->tree_gen != TreeGen)
+    draw_thread(ctx, top);
+}
+
 /* since we may be trying to attach as a pseudo-thread a THREAD that
  * has no message, we have to make a list of all the subjects of its
  * most immediate existing descendants.  we also note the earliest
@@ -409,38 +443,154 @@ static LIST *make_subject_list(THREAD *cur, time_t *dateptr)
   return (subjects);
 }
 
+#define THREAD_DATE(h) (option(OPTTHREADRECEIVED) ? (h)->received : (h)->date_sent)
+
+/* The messages that pseudo_threads() may attach a thread to, for one real
+ * subject.  They are sorted by date, and messages sent at the same time
+ * are in reverse subj_hash order, so that walking down from the latest
+ * date that is early enough finds the same match that a scan of the hash
+ * bucket would.  Messages that can't match any more during the current
+ * pass are skipped over with the below links.
+ */
+struct subject_index
+{
+  HEADER **hdrs;
+  int *below;   /* hdrs[i] is still a candidate if below[i] == i */
+  int count;
+};
+
+struct subject_cand
+{
+  HEADER *hdr;
+  int pos;      /* position in the subj_hash bucket */
+};
+
+static int compare_subject_cands(const void *a, const void *b)
+{
+  const struct subject_cand *ca = a, *cb = b;
+  time_t da = THREAD_DATE(ca->hdr), db = THREAD_DATE(cb->hdr);
+
+  if (da != db)
+    return da < db ? -1 : 1;
+  return cb->pos - ca->pos;
+}
+
+static struct subject_index *make_subject_index(CONTEXT *ctx, const char *subject)
+{
+  struct subject_index *si = safe_calloc(1, sizeof(struct subject_index));
+  struct subject_cand *cands = NULL;
+  struct hash_elem *ptr;
+  HEADER *hdr;
+  int i, n = 0, max = 0;
+
+  for (ptr = hash_find_bucket(ctx->subj_hash, subject); ptr; ptr = ptr->next)
+  {
+    hdr = (HEADER *) ptr->data;
+    /* fake_thread is only ever set and subject_changed only ever cleared
+     * while pseudo_threads() runs, so these can be left out for good */
+    if (hdr->thread->fake_thread || !hdr->subject_changed ||
+        !hdr->env->real_subj || mutt_strcmp(subject, hdr->env->real_subj))
+      continue;
+    if (n == max)
+    {
+      max += 16;
+      safe_realloc(&cands, max * sizeof(struct subject_cand));
+    }
+    cands[n].hdr = hdr;
+    cands[n].pos = n;
+    n++;
+  }
+
+  if (n)
+  {
+    qsort(cands, n, sizeof(struct subject_cand), compare_subject_cands);
+    si->hdrs = safe_malloc(n * sizeof(HEADER *));
+    si->below = safe_malloc(n * sizeof(int));
+    for (i = 0; i < n; i++)
+    {
+      si->hdrs[i] = cands[i].hdr;
+      si->below[i] = i;
+    }
+  }
+  si->count = n;
+  FREE(&cands);
+
+  return si;
+}
+
+static void free_subject_index(void *data)
+{
+  struct subject_index *si = data;
+
+  FREE(&si->hdrs);
+  FREE(&si->below);
+  FREE(&si);
+}
+
+/* returns the highest candidate at or below i, or -1 */
+static int subject_index_live(struct subject_index *si, int i)
+{
+  int top = i, next;
+
+  while (top >= 0 && si->below[top] != top)
+    top = si->below[top];
+  while (i != top)
+  {
+    next = si->below[i];
+    si->below[i] = top;
+    i = next;
+  }
+  return top;
+}
+
 /* find the best possible match for a parent message based upon subject.
  * if there are multiple matches, the one which was sent the latest, but
  * before the current message, is used.
  */
-static THREAD *find_subject(CONTEXT *ctx, THREAD *cur)
+static THREAD *find_subject(CONTEXT *ctx, HASH *index, THREAD *cur)
 {
-  struct hash_elem *ptr;
+  struct subject_index *si;
   THREAD *tmp, *last = NULL;
   LIST *subjects = NULL, *oldlist;
   time_t date = 0;
+  int lo, hi, mid;
 
   subjects = make_subject_list(cur, &date);
 
   while (subjects)
   {
-    for (ptr = hash_find_bucket(ctx->subj_hash, subjects->data); ptr; ptr = ptr->next)
+    if ((si = hash_find(index, subjects->data)) == NULL)
     {
-      tmp = ((HEADER *) ptr->data)->thread;
-      if (tmp != cur &&                    /* don't match the same message */
-          !tmp->fake_thread &&             /* don't match pseudo threads */
-          tmp->message->subject_changed && /* only match interesting replies */
-          !is_descendant(tmp, cur) &&     /* don't match in the same thread */
-          (date >= (option(OPTTHREADRECEIVED) ?
-                    tmp->message->received :
-                    tmp->message->date_sent)) &&
-          (!last ||
-           (option(OPTTHREADRECEIVED) ?
-            (last->message->received < tmp->message->received) :
-            (last->message->date_sent < tmp->message->date_sent))) &&
-          tmp->message->env->real_subj &&
-          mutt_strcmp(subjects->data, tmp->message->env->real_subj) == 0)
+      si = make_subject_index(ctx, subjects->data);
+      hash_insert(index, subjects->data, si);
+    }
+
+    /* find the first candidate sent after us */
+    for (lo = 0, hi = si->count; lo < hi; )
+    {
+      mid = (lo + hi) / 2;
+      if (THREAD_DATE(si->hdrs[mid]) <= date)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    for (mid = subject_index_live(si, lo - 1); mid >= 0;
+         mid = subject_index_live(si, mid - 1))
+    {
+      tmp = si->hdrs[mid]->thread;
+      if (tmp->fake_thread ||               /* don't match pseudo threads */
+          !tmp->message->subject_changed)   /* only match interesting replies */
+      {
+        si->below[mid] = mid - 1;
+        continue;
+      }
+      if (tmp == cur ||                     /* don't match the same message */
+          is_descendant(tmp, cur))          /* don't match in the same thread */
+        continue;
+      if (!last || THREAD_DATE(last->message) < THREAD_DATE(tmp->message))
         last = tmp; /* best match so far */
+      break;
     }
 
     oldlist = subjects;
@@ -503,15 +653,17 @@ static void pseudo_threads(CONTEXT *ctx)
 {
   THREAD *tree = ctx->tree, *top = tree;
   THREAD *tmp, *cur, *parent, *curchild, *nextchild;
+  HASH *index;
 
   if (!ctx->subj_hash)
     ctx->subj_hash = mutt_make_subj_hash(ctx);
+  index = hash_create(1024, 0);
 
   while (tree)
   {
     cur = tree;
     tree = tree->next;
-    if ((parent = find_subject(ctx, cur)) != NULL)
+    if ((parent = find_subject(ctx, index, cur)) != NULL)
     {
       cur->fake_thread = 1;
       unlink_message(&top, cur);
@@ -556,6 +708,7 @@ static void pseudo_threads(CONTEXT *ctx)
     }
   }
   ctx->tree = top;
+  hash_destroy(&index, free_subject_index);
 }
 
 
@@ -1301,6 +1454,8 @@ void mutt_set_virtual(CONTEXT *ctx)
   int i, padding;
   HEADER *cur;
 
+  mutt_invalidate_index_lines();
+
   ctx->vcount = 0;
   ctx->vsize = 0;
   padding = mx_msg_padding_size(ctx);
@@ -1319,6 +1474,17 @@ void mutt_set_virtual(CONTEXT *ctx)
   }
 }
 
+/* Whether a thread has unread messages is asked for every collapsed thread
+ * in the index (%Z) and by the collapse functions, so the answer is kept in
+ * the top-level THREAD.  It stays valid as long as the index lines do:
+ * flag changes, limiting and rethreading all invalidate those. */
+static int cache_unread(THREAD *top, int unread)
+{
+  top->unread = unread;
+  top->unread_gen = mutt_index_lines_gen();
+  return unread;
+}
+
 int _mutt_traverse_thread(CONTEXT *ctx, HEADER *cur, int flag)
 {
   THREAD *thread, *top;
@@ -1339,6 +1505,8 @@ int _mutt_traverse_thread(CONTEXT *ctx, HEADER *cur, int flag)
   while (thread->parent)
     thread = thread->parent;
   top = thread;
+  if ((flag & MUTT_THREAD_UNREAD) && top->unread_gen == mutt_index_lines_gen())
+    return top->unread;
   while (!thread->message)
     thread = thread->child;
   cur = thread->message;
@@ -1380,7 +1548,7 @@ int _mutt_traverse_thread(CONTEXT *ctx, HEADER *cur, int flag)
       return (final);
     }
     else if (flag & MUTT_THREAD_UNREAD)
-      return ((old && new) ? new : (old ? old : new));
+      return cache_unread(top, (old && new) ? new : (old ? old : new));
     else if (flag & MUTT_THREAD_NEXT_UNREAD)
       return (min_unread);
   }
@@ -1494,7 +1662,7 @@ int _mutt_traverse_thread(CONTEXT *ctx, HEADER *cur, int flag)
   if (flag & (MUTT_THREAD_COLLAPSE | MUTT_THREAD_UNCOLLAPSE))
     return (final);
   else if (flag & MUTT_THREAD_UNREAD)
-    return ((old && new) ? new : (old ? old : new));
+    return cache_unread(top, (old && new) ? new : (old ? old : new));
   else if (flag & MUTT_THREAD_NEXT_UNREAD)
     return (min_unread);
 